@@ -0,0 +1,117 @@
+#include "bit_allocation.h"
+#include "decinit.h"
+#include "test_stream.h"
+#include "unpack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Times each stage of the per-frame control path that runs after the scale
+// factors are decoded, on the 64-sample frames of the test stream. Every
+// superframe is unpacked once into its own context, and each stage is then
+// run over all of their channels for a number of passes, taking the fastest
+// of a few rounds. The stages only write their own outputs, so repeating
+// them gives the same result.
+// Usage: control_path [passes]
+
+#define SUPERFRAME_COUNT 24
+#define SUPERFRAME_BYTES 108
+#define ROUNDS 5
+
+typedef struct Stage_s {
+	const char* name;
+	void (*run)(Channel* channel);
+} Stage;
+
+static const Stage Stages[] =
+{
+	{ "CalculateMask", CalculateMask },
+	{ "CalculatePrecisions", CalculatePrecisions },
+	{ "CalculateSpectrumCodebookIndex", CalculateSpectrumCodebookIndex },
+};
+
+static StreamContext* Streams;
+static int ChannelCount;
+
+// Sums the stages' outputs, so that they can't be optimized away and runs
+// can be compared
+static long long Checksum(void)
+{
+	long long sum = 0;
+
+	for (int s = 0; s < SUPERFRAME_COUNT; s++)
+	{
+		for (int ch = 0; ch < ChannelCount; ch++)
+		{
+			const Channel* channel = Streams[s].frame.Channels[ch];
+
+			for (int i = 0; i < channel->block->quantizationUnitCount; i++)
+			{
+				sum += channel->precisionMask[i] + channel->precisions[i] * 3 + channel->precisionsFine[i] * 5;
+				sum += i < channel->codedQuantUnits ? channel->codebookSet[i] * 7 : 0;
+			}
+		}
+	}
+
+	return sum;
+}
+
+static double TimeStage(const Stage* stage, int passes)
+{
+	double fastest = 0;
+
+	for (int round = 0; round < ROUNDS; round++)
+	{
+		const clock_t start = clock();
+
+		for (int pass = 0; pass < passes; pass++)
+		{
+			for (int s = 0; s < SUPERFRAME_COUNT; s++)
+			{
+				for (int ch = 0; ch < ChannelCount; ch++)
+				{
+					stage->run(Streams[s].frame.Channels[ch]);
+				}
+			}
+		}
+
+		const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (round == 0 || seconds < fastest) fastest = seconds;
+	}
+
+	return fastest;
+}
+
+int main(int argc, char** argv)
+{
+	const int passes = argc > 1 ? atoi(argv[1]) : 100000;
+	Streams = malloc(SUPERFRAME_COUNT * sizeof(StreamContext));
+	if (!Streams || passes < 1) return 1;
+
+	for (int s = 0; s < SUPERFRAME_COUNT; s++)
+	{
+		BitReaderCxt br;
+		InitBitReaderCxt(&br, &TestStream[s * SUPERFRAME_BYTES]);
+
+		if (InitStream(&Streams[s], TestStreamConfig) != ERR_SUCCESS || UnpackFrame(&Streams[s].frame, &br) != ERR_SUCCESS)
+		{
+			printf("superframe %d doesn't unpack\n", s);
+			return 1;
+		}
+	}
+
+	ChannelCount = Streams[0].config.channelCount;
+	const long long checksum = Checksum();
+	const double calls = (double)passes * SUPERFRAME_COUNT * ChannelCount;
+
+	for (size_t i = 0; i < sizeof(Stages) / sizeof(Stages[0]); i++)
+	{
+		const double seconds = TimeStage(&Stages[i], passes);
+		printf("%-32s %8.2f ns per channel\n", Stages[i].name, seconds * 1e9 / calls);
+	}
+
+	const int unchanged = Checksum() == checksum;
+	printf("checksum %lld%s\n", checksum, unchanged ? "" : ", changed by the passes");
+	free(Streams);
+	return unchanged ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 #include "structures.h"
 
 void ApplyBandExtension(Block* block);
+void GenerateBexTables();
 
 extern const BexGroup BexGroupInfo[8];
 extern const char BexEncodedValueCounts[5][6];
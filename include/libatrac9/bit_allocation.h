@@ -5,4 +5,5 @@
 At9Status CreateGradient(Block* block);
 void CalculateMask(Channel* channel);
 void CalculatePrecisions(Channel* channel);
+void UpdatePrecisions(Channel* channel);
 void GenerateGradientCurves();
@@ -4,3 +4,9 @@
 #include "structures.h"
 
 At9Status InitDecoder(Atrac9Handle* handle, unsigned char * configData, int wlength);
+// Sets up a stream for unpacking without any of the decoder's output state
+At9Status InitStream(StreamContext* stream, unsigned char* configData);
+// Builds the shared tables on first use. Safe to call from any thread.
+void InitTables(void);
+// Reads the config data without setting up a decoder
+At9Status InitConfigData(ConfigData* config, unsigned char* configData);
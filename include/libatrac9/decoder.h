@@ -8,4 +8,13 @@ At9Status DecodeS32(Atrac9Handle* handle, const void* audio, void* pcm, int* byt
 At9Status DecodeF32(Atrac9Handle* handle, const void* audio, void* pcm, int* bytesUsed);
 At9Status DecodeF64(Atrac9Handle* handle, const void* audio, void* pcm, int* bytesUsed);
 
+At9Status DecodeAccumulateF32(Atrac9Handle* handle, const void* audio, float* pcm, double gainStart, double gainEnd,
+	int* bytesUsed);
+At9Status DecodeSpectra(Frame* frame, const void* audio, int bandExtension, int* isSilent, int* bytesUsed);
+
+void MapOutputChannels(const Frame* frame, const double* const* buffers, const double** pcm);
+At9Status SetChannelMap(Atrac9Handle* handle, const int* map, int count);
+
+FrameDecoder GetFrameDecoder(const ConfigData* config);
+
 int GetCodecInfo(Atrac9Handle* handle, CodecInfo* pCodecInfo);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "structures.h"
+#include <stdint.h>
+
+// The DSP kernels are built once per instruction set and the best one the
+// CPU supports is picked at runtime, so a single build runs everywhere.
+// Every level performs the same sequence of double operations on each
+// element and none of them fuse multiplies into adds, so all levels give
+// bit-identical output.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DSP_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DSP_ARM64
+#endif
+
+#define DSP_LEVEL_AUTO 0
+
+typedef struct {
+	int Level;
+	// Number of doubles processed at once. Batched IMDCTs round the channel
+	// count up to a multiple of this.
+	int Width;
+
+	// DCT-IV of count channels laid out [index][lane] with lanes a
+	// multiple of Width, or a single channel with lanes of 1. Input bins at
+	// or above binCount must be zero.
+	void (*Dct4)(int bits, double* const* inputs, double* output, int count, int lanes, int binCount);
+	// Dequantizes count coefficients. quantizedFine is NULL when the unit
+	// has no fine precision.
+	void (*DequantizeUnit)(const int16_t* quantized, const int16_t* quantizedFine, double* output, int count,
+		double stepSize, double stepSizeFine);
+	void (*ScaleSpectra)(double* spectra, int count, double scale);
+	// spectra[i] *= scale * ramp[i]
+	void (*ScaleSpectraRamp)(double* spectra, const double* ramp, int count, double scale);
+	// Reflects the count bins below bin into the count bins above it
+	void (*MirrorSpectra)(double* spectra, int bin, int count);
+	// Maps 16-bit noise values onto [-1, 1]
+	void (*NoiseToSpectra)(const int* noise, double* spectra, int count);
+	// output[i] += gain * input[i]
+	void (*AccumulateSpectra)(const double* input, double* output, int count, double gain);
+	// Filters count output samples starting phase / outputRate past input[0],
+	// each inputRate / outputRate input samples after the previous one. Each
+	// filter in the bank is taps long.
+	void (*Resample)(const double* filter, int taps, const double* input, double* output, int count, int phase,
+		int inputRate, int outputRate);
+	// Interleave the channels, adding each one's levels to the meter unless
+	// it's NULL
+	void (*PcmToS16)(const double* const* pcm, int channelCount, int sampleCount, int16_t* output, PcmMeter* meter);
+	void (*PcmToS32)(const double* const* pcm, int channelCount, int sampleCount, int32_t* output, PcmMeter* meter);
+	void (*PcmToF32)(const double* const* pcm, int channelCount, int sampleCount, float* output, PcmMeter* meter);
+	void (*PcmToF64)(const double* const* pcm, int channelCount, int sampleCount, double* output, PcmMeter* meter);
+} DspKernels;
+
+extern const DspKernels* Dsp;
+
+// Picks the kernels on first use. The ATRAC9_SIMD environment variable
+// (scalar, sse2, avx2, avx512 or neon) forces a level for testing, falling
+// back to the best supported one if the CPU lacks it.
+void InitDsp(void);
+// Forces a level, or DSP_LEVEL_AUTO for the best supported one. Returns
+// FALSE if the level isn't available on this CPU or in this build.
+int SetDspLevel(int level);
+int GetDspLevel(void);
+
+extern const DspKernels DspKernelsScalar;
+#ifdef DSP_X86
+extern const DspKernels DspKernelsSse2;
+extern const DspKernels DspKernelsAvx2;
+extern const DspKernels DspKernelsAvx512;
+#endif
+#ifdef DSP_ARM64
+extern const DspKernels DspKernelsNeon;
+#endif
@@ -0,0 +1,805 @@
+// DSP kernels, compiled once per instruction set. The including file
+// defines SIMD_LEVEL to pick the instruction set and DSP_KERNELS to name
+// the resulting kernel table. Sizes are not always a multiple of the wider
+// vectors, so every loop finishes with scalar code doing the same
+// operations.
+//
+// The DCT-IV at the heart of the IMDCT is computed with an N/2-point complex
+// FFT wrapped in a pre- and post-twiddle, N being the frame size. Complex
+// values are kept as separate real and imaginary arrays laid out as
+// [index][lane]. A batch of channels is transformed together with one
+// channel per lane; a single channel is vectorized across butterflies.
+//
+// When only the lowest bins of the input are non-zero, the pre-twiddled
+// sequence is zero everywhere except within `edge` values of either end.
+// Every radix-4 stage maps that shape onto each of its sub-blocks, so the
+// butterflies in the zero middle are skipped until the edges meet.
+
+#include "dsp.h"
+#include "simd.h"
+#include "tables.h"
+#include "utility.h"
+#include <stddef.h>
+
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+// Partial sums kept while metering, at least as many as the widest vector
+#define METER_LANES 8
+// Samples that round to outside the 16-bit range
+#define METER_CLIP_HIGH 32767.5
+#define METER_CLIP_LOW -32768.5
+
+static void Dct4(int bits, double* const* inputs, double* output, int count, int lanes, int binCount);
+static FORCE_INLINE void Dct4Size(int bits, double* const* inputs, double* output, int count, int lanes, int binCount);
+static FORCE_INLINE void ImdctPreTwiddle(int bits, double* const* inputs, double* re, double* im, int count, int lanes, int edge);
+static FORCE_INLINE void ImdctPostTwiddle(int bits, const double* re, const double* im, double* output, int lanes);
+
+static void Fft8(double* re, double* im, int lanes, int edge);
+static void Fft16(double* re, double* im, int lanes, int edge);
+static void Fft32(double* re, double* im, int lanes, int edge);
+static void Fft64(double* re, double* im, int lanes, int edge);
+static void Fft128(double* re, double* im, int lanes, int edge);
+static void FftRadix4Stage(double* re, double* im, int size, int blockSizeBits, int lanes, int edge);
+static void FftRadix4Butterflies(double* re, double* im, int block, int start, int end, int blockSizeBits, int lanes);
+static void FftRadix4Last(double* re, double* im, int size, int lanes);
+static void FftRadix2Last(double* re, double* im, int size, int lanes);
+
+static void DequantizeUnit(const int16_t* quantized, const int16_t* quantizedFine, double* output, int count,
+	double stepSize, double stepSizeFine);
+static void ScaleSpectra(double* spectra, int count, double scale);
+static void ScaleSpectraRamp(double* spectra, const double* ramp, int count, double scale);
+static void MirrorSpectra(double* spectra, int bin, int count);
+static void NoiseToSpectra(const int* noise, double* spectra, int count);
+static void AccumulateSpectra(const double* input, double* output, int count, double gain);
+static void Resample(const double* filter, int taps, const double* input, double* output, int count, int phase,
+	int inputRate, int outputRate);
+
+static void PcmToS16(const double* const* pcm, int channelCount, int sampleCount, int16_t* output, PcmMeter* meter);
+static void PcmToS32(const double* const* pcm, int channelCount, int sampleCount, int32_t* output, PcmMeter* meter);
+static void PcmToF32(const double* const* pcm, int channelCount, int sampleCount, float* output, PcmMeter* meter);
+static void PcmToF64(const double* const* pcm, int channelCount, int sampleCount, double* output, PcmMeter* meter);
+static FORCE_INLINE void ConvertChannel(const double* pcm, int* rounded, float* narrowed, int count, PcmMeter* meter,
+	int channel);
+
+const DspKernels DSP_KERNELS =
+{
+	SIMD_LEVEL,
+	SIMD_WIDTH,
+	Dct4,
+	DequantizeUnit,
+	ScaleSpectra,
+	ScaleSpectraRamp,
+	MirrorSpectra,
+	NoiseToSpectra,
+	AccumulateSpectra,
+	Resample,
+	PcmToS16,
+	PcmToS32,
+	PcmToF32,
+	PcmToF64,
+};
+
+// Each frame size gets its own copy of the transform with constant loop
+// bounds and table pointers. Sizes 16 and 32 are the quarter-rate
+// transforms of overviews.
+static void Dct4(int bits, double* const* inputs, double* output, int count, int lanes, int binCount)
+{
+	switch (bits)
+	{
+	case 4:
+		Dct4Size(4, inputs, output, count, lanes, binCount);
+		break;
+	case 5:
+		Dct4Size(5, inputs, output, count, lanes, binCount);
+		break;
+	case 6:
+		Dct4Size(6, inputs, output, count, lanes, binCount);
+		break;
+	case 7:
+		Dct4Size(7, inputs, output, count, lanes, binCount);
+		break;
+	case 8:
+		Dct4Size(8, inputs, output, count, lanes, binCount);
+		break;
+	}
+}
+
+static FORCE_INLINE void Dct4Size(int bits, double* const* inputs, double* output, int count, int lanes, int binCount)
+{
+	double re[MAX_FRAME_SAMPLES / 2 * MAX_CHANNEL_COUNT];
+	double im[MAX_FRAME_SAMPLES / 2 * MAX_CHANNEL_COUNT];
+
+	// Keep the edge a whole number of vectors so single-lane butterflies
+	// never straddle the skipped region.
+	const int edge = ((binCount + 1) / 2 + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+
+	ImdctPreTwiddle(bits, inputs, re, im, count, lanes, edge);
+
+	switch (bits)
+	{
+	case 4:
+		Fft8(re, im, lanes, edge);
+		break;
+	case 5:
+		Fft16(re, im, lanes, edge);
+		break;
+	case 6:
+		Fft32(re, im, lanes, edge);
+		break;
+	case 7:
+		Fft64(re, im, lanes, edge);
+		break;
+	case 8:
+		Fft128(re, im, lanes, edge);
+		break;
+	}
+
+	ImdctPostTwiddle(bits, re, im, output, lanes);
+}
+
+static FORCE_INLINE void ImdctPreTwiddle(int bits, double* const* inputs, double* re, double* im, int count, int lanes, int edge)
+{
+	const int size = 1 << bits;
+	const int fftSize = size / 2;
+	const double* sinTable = SinTables[bits];
+	const double* cosTable = CosTables[bits];
+
+	for (int n = 0; n < fftSize; n++)
+	{
+		const double sin = sinTable[n];
+		const double cos = cosTable[n];
+		double* r = &re[n * lanes];
+		double* i = &im[n * lanes];
+		int ch = 0;
+
+		if (n < edge || n >= fftSize - edge)
+		{
+			for (; ch < count; ch++)
+			{
+				const double a = inputs[ch][2 * n];
+				const double b = inputs[ch][size - 1 - 2 * n];
+				r[ch] = a * cos + b * sin;
+				i[ch] = b * cos - a * sin;
+			}
+		}
+
+		for (; ch < lanes; ch++)
+		{
+			r[ch] = 0;
+			i[ch] = 0;
+		}
+	}
+}
+
+static FORCE_INLINE void ImdctPostTwiddle(int bits, const double* re, const double* im, double* output, int lanes)
+{
+	const int size = 1 << bits;
+	const int fftSize = size / 2;
+	const int* order = FftOrderTables[bits - 4];
+	const double* sinTable = ImdctPostSin[bits - 4];
+	const double* cosTable = ImdctPostCos[bits - 4];
+
+	if (lanes == 1)
+	{
+		for (int p = 0; p < fftSize; p++)
+		{
+			const int k = order[p];
+			output[2 * k] = re[p] * cosTable[p] + im[p] * sinTable[p];
+			output[size - 1 - 2 * k] = re[p] * sinTable[p] - im[p] * cosTable[p];
+		}
+		return;
+	}
+
+	for (int p = 0; p < fftSize; p++)
+	{
+		const int k = order[p];
+		const SimdDouble sin = SimdSet1(sinTable[p]);
+		const SimdDouble cos = SimdSet1(cosTable[p]);
+		const double* r = &re[p * lanes];
+		const double* i = &im[p * lanes];
+		double* even = &output[2 * k * lanes];
+		double* odd = &output[(size - 1 - 2 * k) * lanes];
+
+		for (int ch = 0; ch < lanes; ch += SIMD_WIDTH)
+		{
+			const SimdDouble vr = SimdLoad(&r[ch]);
+			const SimdDouble vi = SimdLoad(&i[ch]);
+			SimdStore(&even[ch], SimdAdd(SimdMul(vr, cos), SimdMul(vi, sin)));
+			SimdStore(&odd[ch], SimdSub(SimdMul(vr, sin), SimdMul(vi, cos)));
+		}
+	}
+}
+
+// Size-specific FFT codelets. Stages are decimation-in-frequency, so the
+// result is left in the digit-reversed order given by FftOrderTables.
+
+static void Fft8(double* re, double* im, int lanes, int edge)
+{
+	FftRadix4Stage(re, im, 8, 3, lanes, edge);
+	FftRadix2Last(re, im, 8, lanes);
+}
+
+static void Fft16(double* re, double* im, int lanes, int edge)
+{
+	FftRadix4Stage(re, im, 16, 4, lanes, edge);
+	FftRadix4Last(re, im, 16, lanes);
+}
+
+static void Fft32(double* re, double* im, int lanes, int edge)
+{
+	FftRadix4Stage(re, im, 32, 5, lanes, edge);
+	FftRadix4Stage(re, im, 32, 3, lanes, edge);
+	FftRadix2Last(re, im, 32, lanes);
+}
+
+static void Fft64(double* re, double* im, int lanes, int edge)
+{
+	FftRadix4Stage(re, im, 64, 6, lanes, edge);
+	FftRadix4Stage(re, im, 64, 4, lanes, edge);
+	FftRadix4Last(re, im, 64, lanes);
+}
+
+static void Fft128(double* re, double* im, int lanes, int edge)
+{
+	FftRadix4Stage(re, im, 128, 7, lanes, edge);
+	FftRadix4Stage(re, im, 128, 5, lanes, edge);
+	FftRadix4Stage(re, im, 128, 3, lanes, edge);
+	FftRadix2Last(re, im, 128, lanes);
+}
+
+static inline void Radix4Butterfly(double* re, double* im, int stride,
+	SimdDouble cos1, SimdDouble sin1, SimdDouble cos2, SimdDouble sin2, SimdDouble cos3, SimdDouble sin3)
+{
+	const SimdDouble a0r = SimdLoad(&re[0]);
+	const SimdDouble a0i = SimdLoad(&im[0]);
+	const SimdDouble a1r = SimdLoad(&re[stride]);
+	const SimdDouble a1i = SimdLoad(&im[stride]);
+	const SimdDouble a2r = SimdLoad(&re[stride * 2]);
+	const SimdDouble a2i = SimdLoad(&im[stride * 2]);
+	const SimdDouble a3r = SimdLoad(&re[stride * 3]);
+	const SimdDouble a3i = SimdLoad(&im[stride * 3]);
+
+	const SimdDouble b0r = SimdAdd(a0r, a2r);
+	const SimdDouble b0i = SimdAdd(a0i, a2i);
+	const SimdDouble b1r = SimdSub(a0r, a2r);
+	const SimdDouble b1i = SimdSub(a0i, a2i);
+	const SimdDouble b2r = SimdAdd(a1r, a3r);
+	const SimdDouble b2i = SimdAdd(a1i, a3i);
+	const SimdDouble b3r = SimdSub(a1r, a3r);
+	const SimdDouble b3i = SimdSub(a1i, a3i);
+
+	const SimdDouble y1r = SimdAdd(b1r, b3i);
+	const SimdDouble y1i = SimdSub(b1i, b3r);
+	const SimdDouble y2r = SimdSub(b0r, b2r);
+	const SimdDouble y2i = SimdSub(b0i, b2i);
+	const SimdDouble y3r = SimdSub(b1r, b3i);
+	const SimdDouble y3i = SimdAdd(b1i, b3r);
+
+	SimdStore(&re[0], SimdAdd(b0r, b2r));
+	SimdStore(&im[0], SimdAdd(b0i, b2i));
+	SimdStore(&re[stride], SimdAdd(SimdMul(y1r, cos1), SimdMul(y1i, sin1)));
+	SimdStore(&im[stride], SimdSub(SimdMul(y1i, cos1), SimdMul(y1r, sin1)));
+	SimdStore(&re[stride * 2], SimdAdd(SimdMul(y2r, cos2), SimdMul(y2i, sin2)));
+	SimdStore(&im[stride * 2], SimdSub(SimdMul(y2i, cos2), SimdMul(y2r, sin2)));
+	SimdStore(&re[stride * 3], SimdAdd(SimdMul(y3r, cos3), SimdMul(y3i, sin3)));
+	SimdStore(&im[stride * 3], SimdSub(SimdMul(y3i, cos3), SimdMul(y3r, sin3)));
+}
+
+static inline void Radix4ButterflyScalar(double* re, double* im, int stride,
+	double cos1, double sin1, double cos2, double sin2, double cos3, double sin3)
+{
+	const double b0r = re[0] + re[stride * 2];
+	const double b0i = im[0] + im[stride * 2];
+	const double b1r = re[0] - re[stride * 2];
+	const double b1i = im[0] - im[stride * 2];
+	const double b2r = re[stride] + re[stride * 3];
+	const double b2i = im[stride] + im[stride * 3];
+	const double b3r = re[stride] - re[stride * 3];
+	const double b3i = im[stride] - im[stride * 3];
+
+	const double y1r = b1r + b3i;
+	const double y1i = b1i - b3r;
+	const double y2r = b0r - b2r;
+	const double y2i = b0i - b2i;
+	const double y3r = b1r - b3i;
+	const double y3i = b1i + b3r;
+
+	re[0] = b0r + b2r;
+	im[0] = b0i + b2i;
+	re[stride] = y1r * cos1 + y1i * sin1;
+	im[stride] = y1i * cos1 - y1r * sin1;
+	re[stride * 2] = y2r * cos2 + y2i * sin2;
+	im[stride * 2] = y2i * cos2 - y2r * sin2;
+	re[stride * 3] = y3r * cos3 + y3i * sin3;
+	im[stride * 3] = y3i * cos3 - y3r * sin3;
+}
+
+static void FftRadix4Stage(double* re, double* im, int size, int blockSizeBits, int lanes, int edge)
+{
+	const int blockSize = 1 << blockSizeBits;
+	const int quarter = blockSize / 4;
+	const int skipStart = edge < quarter - edge ? edge : quarter;
+	const int skipEnd = edge < quarter - edge ? quarter - edge : quarter;
+
+	for (int block = 0; block < size; block += blockSize)
+	{
+		FftRadix4Butterflies(re, im, block, 0, skipStart, blockSizeBits, lanes);
+		FftRadix4Butterflies(re, im, block, skipEnd, quarter, blockSizeBits, lanes);
+	}
+}
+
+static void FftRadix4Butterflies(double* re, double* im, int block, int start, int end, int blockSizeBits, int lanes)
+{
+	const int quarter = 1 << (blockSizeBits - 2);
+	const double* cos1 = FftTwiddleCos[blockSizeBits][0];
+	const double* cos2 = FftTwiddleCos[blockSizeBits][1];
+	const double* cos3 = FftTwiddleCos[blockSizeBits][2];
+	const double* sin1 = FftTwiddleSin[blockSizeBits][0];
+	const double* sin2 = FftTwiddleSin[blockSizeBits][1];
+	const double* sin3 = FftTwiddleSin[blockSizeBits][2];
+
+	if (lanes == 1)
+	{
+		int j = start;
+
+		for (; j + SIMD_WIDTH <= end; j += SIMD_WIDTH)
+		{
+			Radix4Butterfly(&re[block + j], &im[block + j], quarter,
+				SimdLoad(&cos1[j]), SimdLoad(&sin1[j]),
+				SimdLoad(&cos2[j]), SimdLoad(&sin2[j]),
+				SimdLoad(&cos3[j]), SimdLoad(&sin3[j]));
+		}
+
+		// The last stages of the wider levels have quarters narrower than
+		// a vector
+		for (; j < end; j++)
+		{
+			Radix4ButterflyScalar(&re[block + j], &im[block + j], quarter,
+				cos1[j], sin1[j], cos2[j], sin2[j], cos3[j], sin3[j]);
+		}
+		return;
+	}
+
+	for (int j = start; j < end; j++)
+	{
+		const SimdDouble c1 = SimdSet1(cos1[j]);
+		const SimdDouble s1 = SimdSet1(sin1[j]);
+		const SimdDouble c2 = SimdSet1(cos2[j]);
+		const SimdDouble s2 = SimdSet1(sin2[j]);
+		const SimdDouble c3 = SimdSet1(cos3[j]);
+		const SimdDouble s3 = SimdSet1(sin3[j]);
+		double* r = &re[(block + j) * lanes];
+		double* i = &im[(block + j) * lanes];
+
+		for (int ch = 0; ch < lanes; ch += SIMD_WIDTH)
+		{
+			Radix4Butterfly(&r[ch], &i[ch], quarter * lanes, c1, s1, c2, s2, c3, s3);
+		}
+	}
+}
+
+static void FftRadix4Last(double* re, double* im, int size, int lanes)
+{
+	if (lanes == 1)
+	{
+		for (int block = 0; block < size; block += 4)
+		{
+			double* r = &re[block];
+			double* i = &im[block];
+			const double b0r = r[0] + r[2];
+			const double b0i = i[0] + i[2];
+			const double b1r = r[0] - r[2];
+			const double b1i = i[0] - i[2];
+			const double b2r = r[1] + r[3];
+			const double b2i = i[1] + i[3];
+			const double b3r = r[1] - r[3];
+			const double b3i = i[1] - i[3];
+			r[0] = b0r + b2r;
+			i[0] = b0i + b2i;
+			r[1] = b1r + b3i;
+			i[1] = b1i - b3r;
+			r[2] = b0r - b2r;
+			i[2] = b0i - b2i;
+			r[3] = b1r - b3i;
+			i[3] = b1i + b3r;
+		}
+		return;
+	}
+
+	for (int block = 0; block < size; block += 4)
+	{
+		double* r = &re[block * lanes];
+		double* i = &im[block * lanes];
+
+		for (int ch = 0; ch < lanes; ch += SIMD_WIDTH)
+		{
+			const SimdDouble a0r = SimdLoad(&r[ch]);
+			const SimdDouble a0i = SimdLoad(&i[ch]);
+			const SimdDouble a1r = SimdLoad(&r[ch + lanes]);
+			const SimdDouble a1i = SimdLoad(&i[ch + lanes]);
+			const SimdDouble a2r = SimdLoad(&r[ch + lanes * 2]);
+			const SimdDouble a2i = SimdLoad(&i[ch + lanes * 2]);
+			const SimdDouble a3r = SimdLoad(&r[ch + lanes * 3]);
+			const SimdDouble a3i = SimdLoad(&i[ch + lanes * 3]);
+			const SimdDouble b0r = SimdAdd(a0r, a2r);
+			const SimdDouble b0i = SimdAdd(a0i, a2i);
+			const SimdDouble b1r = SimdSub(a0r, a2r);
+			const SimdDouble b1i = SimdSub(a0i, a2i);
+			const SimdDouble b2r = SimdAdd(a1r, a3r);
+			const SimdDouble b2i = SimdAdd(a1i, a3i);
+			const SimdDouble b3r = SimdSub(a1r, a3r);
+			const SimdDouble b3i = SimdSub(a1i, a3i);
+			SimdStore(&r[ch], SimdAdd(b0r, b2r));
+			SimdStore(&i[ch], SimdAdd(b0i, b2i));
+			SimdStore(&r[ch + lanes], SimdAdd(b1r, b3i));
+			SimdStore(&i[ch + lanes], SimdSub(b1i, b3r));
+			SimdStore(&r[ch + lanes * 2], SimdSub(b0r, b2r));
+			SimdStore(&i[ch + lanes * 2], SimdSub(b0i, b2i));
+			SimdStore(&r[ch + lanes * 3], SimdSub(b1r, b3i));
+			SimdStore(&i[ch + lanes * 3], SimdAdd(b1i, b3r));
+		}
+	}
+}
+
+static void FftRadix2Last(double* re, double* im, int size, int lanes)
+{
+	const int count = size * lanes;
+
+	if (lanes == 1)
+	{
+		for (int n = 0; n < count; n += 2)
+		{
+			const double ar = re[n];
+			const double ai = im[n];
+			re[n] = ar + re[n + 1];
+			im[n] = ai + im[n + 1];
+			re[n + 1] = ar - re[n + 1];
+			im[n + 1] = ai - im[n + 1];
+		}
+		return;
+	}
+
+	for (int n = 0; n < count; n += lanes * 2)
+	{
+		for (int ch = n; ch < n + lanes; ch += SIMD_WIDTH)
+		{
+			const SimdDouble ar = SimdLoad(&re[ch]);
+			const SimdDouble ai = SimdLoad(&im[ch]);
+			const SimdDouble br = SimdLoad(&re[ch + lanes]);
+			const SimdDouble bi = SimdLoad(&im[ch + lanes]);
+			SimdStore(&re[ch], SimdAdd(ar, br));
+			SimdStore(&im[ch], SimdAdd(ai, bi));
+			SimdStore(&re[ch + lanes], SimdSub(ar, br));
+			SimdStore(&im[ch + lanes], SimdSub(ai, bi));
+		}
+	}
+}
+
+static void DequantizeUnit(const int16_t* quantized, const int16_t* quantizedFine, double* output, int count,
+	double stepSize, double stepSizeFine)
+{
+	const SimdDouble step = SimdSet1(stepSize);
+	const SimdDouble stepFine = SimdSet1(stepSizeFine);
+	int i = 0;
+
+	if (!quantizedFine)
+	{
+		for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+		{
+			SimdStore(&output[i], SimdMul(SimdLoadInt16(&quantized[i]), step));
+		}
+
+		for (; i < count; i++)
+		{
+			output[i] = quantized[i] * stepSize;
+		}
+		return;
+	}
+
+	for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+	{
+		const SimdDouble coarse = SimdMul(SimdLoadInt16(&quantized[i]), step);
+		const SimdDouble fine = SimdMul(SimdLoadInt16(&quantizedFine[i]), stepFine);
+		SimdStore(&output[i], SimdAdd(coarse, fine));
+	}
+
+	for (; i < count; i++)
+	{
+		const double coarse = quantized[i] * stepSize;
+		const double fine = quantizedFine[i] * stepSizeFine;
+		output[i] = coarse + fine;
+	}
+}
+
+static void ScaleSpectra(double* spectra, int count, double scale)
+{
+	const SimdDouble scaleVec = SimdSet1(scale);
+	int i = 0;
+
+	for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+	{
+		SimdStore(&spectra[i], SimdMul(SimdLoad(&spectra[i]), scaleVec));
+	}
+
+	for (; i < count; i++)
+	{
+		spectra[i] *= scale;
+	}
+}
+
+static void ScaleSpectraRamp(double* spectra, const double* ramp, int count, double scale)
+{
+	const SimdDouble scaleVec = SimdSet1(scale);
+	int i = 0;
+
+	for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+	{
+		const SimdDouble gain = SimdMul(scaleVec, SimdLoad(&ramp[i]));
+		SimdStore(&spectra[i], SimdMul(SimdLoad(&spectra[i]), gain));
+	}
+
+	for (; i < count; i++)
+	{
+		const double gain = scale * ramp[i];
+		spectra[i] *= gain;
+	}
+}
+
+static void MirrorSpectra(double* spectra, int bin, int count)
+{
+	int i = 0;
+
+	for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+	{
+		SimdStore(&spectra[bin + i], SimdReverse(SimdLoad(&spectra[bin - i - SIMD_WIDTH])));
+	}
+
+	for (; i < count; i++)
+	{
+		spectra[bin + i] = spectra[bin - i - 1];
+	}
+}
+
+static void NoiseToSpectra(const int* noise, double* spectra, int count)
+{
+	const SimdDouble noiseMax = SimdSet1(65535.0);
+	const SimdDouble two = SimdSet1(2.0);
+	const SimdDouble one = SimdSet1(1.0);
+	int i = 0;
+
+	for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+	{
+		const SimdDouble value = SimdDiv(SimdLoadInt32(&noise[i]), noiseMax);
+		SimdStore(&spectra[i], SimdSub(SimdMul(value, two), one));
+	}
+
+	for (; i < count; i++)
+	{
+		const double value = noise[i] / 65535.0;
+		spectra[i] = value * 2.0 - 1.0;
+	}
+}
+
+static void AccumulateSpectra(const double* input, double* output, int count, double gain)
+{
+	const SimdDouble gainVec = SimdSet1(gain);
+	int i = 0;
+
+	for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
+	{
+		const SimdDouble value = SimdMul(SimdLoad(&input[i]), gainVec);
+		SimdStore(&output[i], SimdAdd(SimdLoad(&output[i]), value));
+	}
+
+	for (; i < count; i++)
+	{
+		const double value = input[i] * gain;
+		output[i] += value;
+	}
+}
+
+// Each tap is paired with the one half a filter later and the pairs are
+// summed in a fixed order, so the result doesn't depend on the width
+static void Resample(const double* filter, int taps, const double* input, double* output, int count, int phase,
+	int inputRate, int outputRate)
+{
+	const int half = taps / 2;
+	const double phaseScale = (double)RESAMPLER_PHASES / outputRate;
+
+	// The sums are folded down to a power of two before halving them
+	int fold = 1;
+	while (fold * 2 <= half)
+	{
+		fold *= 2;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		const double position = phase * phaseScale;
+		const int index = (int)position;
+		const SimdDouble fraction = SimdSet1(position - index);
+		const double* lower = &filter[index * taps];
+		const double* upper = &filter[(index + 1) * taps];
+		CACHE_ALIGNED double sums[MAX_RESAMPLER_TAPS / 2];
+
+		for (int j = 0; j < half; j += SIMD_WIDTH)
+		{
+			const SimdDouble lowerA = SimdLoad(&lower[j]);
+			const SimdDouble lowerB = SimdLoad(&lower[j + half]);
+			const SimdDouble tapA = SimdAdd(lowerA, SimdMul(fraction, SimdSub(SimdLoad(&upper[j]), lowerA)));
+			const SimdDouble tapB = SimdAdd(lowerB, SimdMul(fraction, SimdSub(SimdLoad(&upper[j + half]), lowerB)));
+			const SimdDouble productA = SimdMul(tapA, SimdLoad(&input[j]));
+			const SimdDouble productB = SimdMul(tapB, SimdLoad(&input[j + half]));
+			SimdStore(&sums[j], SimdAdd(productA, productB));
+		}
+
+		for (int j = fold; j < half; j++)
+		{
+			sums[j - fold] += sums[j];
+		}
+
+		for (int width = fold / 2; width > 0; width /= 2)
+		{
+			for (int j = 0; j < width; j++)
+			{
+				sums[j] += sums[j + width];
+			}
+		}
+
+		output[i] = sums[0];
+
+		phase += inputRate;
+		while (phase >= outputRate)
+		{
+			phase -= outputRate;
+			input++;
+		}
+	}
+}
+
+// Each channel is converted on its own and then interleaved into the output.
+// ConvertChannel is called with and without a meter so both get their own
+// copy of the loop.
+static void PcmToS16(const double* const* pcm, int channelCount, int sampleCount, int16_t* output, PcmMeter* meter)
+{
+	int rounded[MAX_OUTPUT_SAMPLES];
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		if (meter) ConvertChannel(pcm[ch], rounded, NULL, sampleCount, meter, ch);
+		else ConvertChannel(pcm[ch], rounded, NULL, sampleCount, NULL, ch);
+
+		for (int i = 0; i < sampleCount; i++)
+		{
+			const int value = rounded[i] > INT16_MAX ? INT16_MAX : rounded[i] < INT16_MIN ? INT16_MIN : rounded[i];
+			output[i * channelCount + ch] = (int16_t)value;
+		}
+	}
+}
+
+static void PcmToS32(const double* const* pcm, int channelCount, int sampleCount, int32_t* output, PcmMeter* meter)
+{
+	int rounded[MAX_OUTPUT_SAMPLES];
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		if (meter) ConvertChannel(pcm[ch], rounded, NULL, sampleCount, meter, ch);
+		else ConvertChannel(pcm[ch], rounded, NULL, sampleCount, NULL, ch);
+
+		for (int i = 0; i < sampleCount; i++)
+		{
+			output[i * channelCount + ch] = rounded[i];
+		}
+	}
+}
+
+static void PcmToF32(const double* const* pcm, int channelCount, int sampleCount, float* output, PcmMeter* meter)
+{
+	float narrowed[MAX_OUTPUT_SAMPLES];
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		if (meter) ConvertChannel(pcm[ch], NULL, narrowed, sampleCount, meter, ch);
+		else ConvertChannel(pcm[ch], NULL, narrowed, sampleCount, NULL, ch);
+
+		for (int i = 0; i < sampleCount; i++)
+		{
+			output[i * channelCount + ch] = narrowed[i];
+		}
+	}
+}
+
+static void PcmToF64(const double* const* pcm, int channelCount, int sampleCount, double* output, PcmMeter* meter)
+{
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		const double* input = pcm[ch];
+
+		if (meter) ConvertChannel(input, NULL, NULL, sampleCount, meter, ch);
+
+		for (int i = 0; i < sampleCount; i++)
+		{
+			output[i * channelCount + ch] = input[i];
+		}
+	}
+}
+
+// Rounds a channel half up, narrows it to floats, or only measures it when
+// neither output is given. Rounding truncates the biased value and steps
+// down when that rounded toward zero from below.
+//
+// The squares are summed into METER_LANES partial sums by index and then
+// pairwise, so the sum doesn't depend on the width. Clips are rare enough
+// to be counted in a second pass once the peak shows there are some.
+static FORCE_INLINE void ConvertChannel(const double* pcm, int* rounded, float* narrowed, int count, PcmMeter* meter,
+	int channel)
+{
+	CACHE_ALIGNED double squares[METER_LANES] = { 0 };
+	CACHE_ALIGNED double peaks[SIMD_WIDTH];
+	SimdDouble peakVec = SimdZero();
+	double peak = 0;
+	int i = 0;
+
+	for (; i + METER_LANES <= count; i += METER_LANES)
+	{
+		for (int j = 0; j < METER_LANES; j += SIMD_WIDTH)
+		{
+			const SimdDouble x = SimdLoad(&pcm[i + j]);
+
+			if (rounded) SimdStoreRoundI32(&rounded[i + j], x);
+			if (narrowed) SimdStoreF32(&narrowed[i + j], x);
+			if (meter)
+			{
+				SimdStore(&squares[j], SimdAdd(SimdLoad(&squares[j]), SimdMul(x, x)));
+				peakVec = SimdMax(peakVec, SimdMax(x, SimdSub(SimdZero(), x)));
+			}
+		}
+	}
+
+	for (; i < count; i++)
+	{
+		const double x = pcm[i];
+
+		if (rounded)
+		{
+			const double biased = x + 0.5;
+			rounded[i] = (int)biased - (biased < (int)biased);
+		}
+		if (narrowed) narrowed[i] = (float)x;
+		if (meter)
+		{
+			const double magnitude = x > 0 - x ? x : 0 - x;
+			squares[i % METER_LANES] += x * x;
+			peak = peak > magnitude ? peak : magnitude;
+		}
+	}
+
+	if (!meter) return;
+
+	SimdStore(peaks, peakVec);
+	for (int lane = 0; lane < SIMD_WIDTH; lane++)
+	{
+		peak = peak > peaks[lane] ? peak : peaks[lane];
+	}
+
+	for (int width = METER_LANES / 2; width > 0; width /= 2)
+	{
+		for (int j = 0; j < width; j++)
+		{
+			squares[j] += squares[j + width];
+		}
+	}
+
+	meter->SumSquares[channel] += squares[0];
+	meter->Peak[channel] = meter->Peak[channel] > peak ? meter->Peak[channel] : peak;
+
+	if (peak >= METER_CLIP_HIGH)
+	{
+		for (i = 0; i < count; i++)
+		{
+			meter->Clips[channel] += pcm[i] >= METER_CLIP_HIGH || pcm[i] < METER_CLIP_LOW;
+		}
+	}
+}
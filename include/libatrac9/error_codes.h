@@ -22,7 +22,35 @@ typedef enum At9Status
 	ERR_UNPACK_SCALE_FACTOR_MODE_INVALID,
 	ERR_UNPACK_SCALE_FACTOR_OOB,
 
-	ERR_UNPACK_EXTENSION_DATA_INVALID
+	ERR_UNPACK_EXTENSION_DATA_INVALID,
+
+	ERR_MIXER_LAYOUT_INVALID = 0x83000000,
+	ERR_MIXER_VOICE_MISMATCH,
+
+	ERR_SPECTRAL_GAIN_INVALID = 0x84000000,
+
+	ERR_RESAMPLER_RATE_INVALID = 0x85000000,
+	ERR_RESAMPLER_UNSUPPORTED,
+
+	ERR_CHANNEL_MAP_INVALID = 0x86000000,
+
+	ERR_METERING_DISABLED = 0x87000000,
+
+	ERR_VALIDATE_RANGE_INVALID = 0x88000000,
+	ERR_VALIDATE_SUPERFRAME_TRUNCATED,
+	ERR_VALIDATE_SUPERFRAME_OVERRUN,
+	ERR_VALIDATE_SUPERFRAME_DEPENDENT,
+
+	ERR_RIFF_OPEN_FAILED = 0x89000000,
+	ERR_RIFF_FILE_TOO_LARGE,
+	ERR_RIFF_HEADER_INVALID,
+	ERR_RIFF_FORMAT_UNSUPPORTED,
+	ERR_RIFF_CHUNK_MISSING,
+	ERR_RIFF_CONFIG_MISMATCH,
+
+	ERR_TRIM_INVALID = 0x8A000000,
+
+	ERR_LOOP_INVALID = 0x8B000000
 } At9Status;
 
 #define ERROR_CHECK(x) do { \
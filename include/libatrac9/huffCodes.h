@@ -1,6 +1,7 @@
 #pragma once
 
 #include "bit_reader.h"
+#include <stdint.h>
 
 typedef struct
 {
@@ -16,7 +17,7 @@ typedef struct
 } HuffmanCodebook;
 
 int ReadHuffmanValue(const HuffmanCodebook* huff, BitReaderCxt* br, int isSigned);
-void DecodeHuffmanValues(int* spectrum, int index, int bandCount, const HuffmanCodebook* huff, const int* values);
+void DecodeHuffmanValues(int16_t* spectrum, int index, int bandCount, const HuffmanCodebook* huff, const int* values);
 void InitHuffmanCodebook(const HuffmanCodebook* codebook);
 
 extern HuffmanCodebook HuffmanScaleFactorsUnsigned[7];
@@ -3,3 +3,7 @@
 #include "structures.h"
 
 void RunImdct(Mdct* mdct, double* input, double* output);
+void RunImdctBatch(Mdct* const* mdcts, double* const* inputs, double* const* outputs, int count, int binCount);
+void RunImdctBatchAccumulate(Mdct* const* mdcts, double* const* inputs, float* const* outputs, int stride, int count,
+	int binCount, double gain, double gainStep);
+void RunImdctSilent(Mdct* mdct, double* output);
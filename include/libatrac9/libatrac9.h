@@ -14,6 +14,9 @@ extern "C" {
 #endif
 
 #define ATRAC9_CONFIG_DATA_SIZE 4
+#define ATRAC9_QUANT_UNIT_COUNT 30
+#define ATRAC9_MAX_CHANNEL_COUNT 8
+#define ATRAC9_MAX_BAND_COUNT 18
 
 typedef struct {
 	int channels;
@@ -26,6 +29,88 @@ typedef struct {
 	unsigned char configData[ATRAC9_CONFIG_DATA_SIZE];
 } Atrac9CodecInfo;
 
+typedef struct {
+	int channels;
+	int samples;
+	double peak[ATRAC9_MAX_CHANNEL_COUNT];
+	double sumSquares[ATRAC9_MAX_CHANNEL_COUNT];
+	int clips[ATRAC9_MAX_CHANNEL_COUNT];
+} Atrac9Meter;
+
+typedef struct {
+	int superframeSize;
+	int superframeCount;
+	int superframesChecked;
+	int failedSuperframe;
+	int failedFrame;
+	int error;
+} Atrac9ValidationReport;
+
+// Histograms are indexed by the value read from the stream
+typedef struct {
+	int frames;
+	int blocks;
+	int bandCount[ATRAC9_MAX_BAND_COUNT + 1];
+	int stereoBand[ATRAC9_MAX_BAND_COUNT + 1];
+	int extensionBand[ATRAC9_MAX_BAND_COUNT + 1];
+	// Mode 4 is a band extension too narrow to code a mode
+	int bexMode[5];
+	int gradientMode[4];
+	// By channel within a block
+	int scaleFactorCodingMode[2][4];
+	// Quant units coded with each Huffman codebook set and precision
+	int huffmanUnits[2][8];
+	int fixedLengthUnits;
+	long long spectraBits;
+	long long sideInfoBits;
+	long long paddingBits;
+} Atrac9StreamStats;
+
+typedef struct {
+	int firstFrame;
+	int frameCount;
+} Atrac9SilentRegion;
+
+typedef struct {
+	int frames;
+	int frameSamples;
+	int samplingRate;
+	// In LUFS, or -HUGE_VAL when every block is below the absolute gate
+	double integratedLoudness;
+	// Including any that didn't fit in pRegions
+	int silentRegionCount;
+	int failedSuperframe;
+	int error;
+} Atrac9LoudnessReport;
+
+typedef struct {
+	float min;
+	float max;
+	float rms;
+} Atrac9OverviewBucket;
+
+typedef struct {
+	int channels;
+	int buckets;
+	int failedSuperframe;
+	int error;
+} Atrac9OverviewReport;
+
+typedef struct {
+	Atrac9CodecInfo codecInfo;
+	// Samples left once encoderDelay samples are dropped from the start of
+	// the decoded stream
+	int sampleCount;
+	int encoderDelay;
+	// Past the encoder delay, with the end exclusive, or -1 when the file
+	// doesn't loop
+	int loopStart;
+	int loopEnd;
+	int dataOffset;
+	int dataSize;
+	int superframeCount;
+} Atrac9FileInfo;
+
 typedef enum {
 	kAtrac9FormatS16,
 	kAtrac9FormatS32,
@@ -33,14 +118,182 @@ typedef enum {
 	kAtrac9FormatF64,
 } Atrac9Format;
 
+typedef enum {
+	kAtrac9SimdAuto,
+	kAtrac9SimdScalar,
+	kAtrac9SimdSse2,
+	kAtrac9SimdAvx2,
+	kAtrac9SimdAvx512,
+	kAtrac9SimdNeon,
+} Atrac9SimdLevel;
+
 DLLEXPORT void* Atrac9GetHandle(void);
 DLLEXPORT void Atrac9ReleaseHandle(void* handle);
 
 DLLEXPORT int Atrac9InitDecoder(void* handle, unsigned char *pConfigData);
 DLLEXPORT int Atrac9Decode(void* handle, const void *pAtrac9Buffer, void *pPcmBuffer, Atrac9Format format, int *pNBytesUsed);
 
+// Decodes a frame and adds it to the F32 samples already in pPcmBuffer. The
+// gain ramps linearly from gainStart on the first sample towards gainEnd,
+// which is where the next frame's ramp should start. The samples are laid
+// out in the handle's channel map, as Atrac9Decode writes them, and output
+// channels mapped to -1 are left as they are. Reordering costs nothing, but
+// dropping or duplicating channels stores the frame's PCM first.
+DLLEXPORT int Atrac9DecodeAccumulate(void* handle, const void *pAtrac9Buffer, float *pPcmBuffer, float gainStart, float gainEnd, int *pNBytesUsed);
+
 DLLEXPORT int Atrac9GetCodecInfo(void* handle, Atrac9CodecInfo *pCodecInfo);
 
+// Checks that every frame of a stream parses, without dequantizing or
+// transforming anything. pBuffer holds size bytes of superframes. Returns 0
+// if they all parse, or the error of the first one that doesn't. pReport
+// gives its index and the frame within it, which is -1 when the superframe
+// is cut short. A superframe whose first frame carries state over from the
+// previous one, which Atrac9Decode plays but which can't be checked on its
+// own, fails with an error of its own rather than a parse error.
+DLLEXPORT int Atrac9Validate(unsigned char *pConfigData, const void *pBuffer, int size, Atrac9ValidationReport *pReport);
+// Checks up to superframeCount superframes starting at firstSuperframe.
+// Superframes don't depend on each other, so the ranges of a stream can be
+// checked on separate threads. A count of 0 only fills in superframeSize
+// and superframeCount.
+DLLEXPORT int Atrac9ValidateRange(unsigned char *pConfigData, const void *pBuffer, int size, int firstSuperframe,
+	int superframeCount, Atrac9ValidationReport *pReport);
+
+// Validates a range of superframes like Atrac9ValidateRange while counting
+// the coding tools and parameters its frames use, for tuning encoders and
+// finding streams that exercise rare paths. Only frames read up to the
+// first failure given in pReport are counted. Every field is a sum, so the
+// stats of separate ranges can be added together.
+DLLEXPORT int Atrac9Analyze(unsigned char *pConfigData, const void *pBuffer, int size, int firstSuperframe,
+	int superframeCount, Atrac9StreamStats *pStats, Atrac9ValidationReport *pReport);
+
+// Measures a stream from its decoded spectra, skipping the IMDCT and PCM
+// conversion, for loudness normalization and silence trimming. pEnvelope
+// gets the K-weighted power of each frame relative to full scale, summed
+// over channels with the BS.1770 weights, for up to envelopeSize frames;
+// -0.691 + 10 * log10(power) is its loudness in LUFS. Runs of at least
+// minSilentFrames frames quieter than silenceThreshold LUFS are written to
+// pRegions, up to regionCapacity of them. integratedLoudness is gated as in
+// BS.1770 and is usually within a few tenths of an LU of measuring the
+// decoded PCM. The scan stops at the first superframe that fails to decode,
+// and everything before it is still reported. Either output array can be
+// NULL with a size of 0.
+DLLEXPORT int Atrac9ScanLoudness(unsigned char *pConfigData, const void *pBuffer, int size, double silenceThreshold,
+	int minSilentFrames, double *pEnvelope, int envelopeSize, Atrac9SilentRegion *pRegions, int regionCapacity,
+	Atrac9LoudnessReport *pReport);
+
+// Draws a waveform thumbnail: the minimum, maximum and RMS of each channel
+// over every bucketSamples samples, in 16-bit units. Bucket i of channel c
+// is pBuckets[i * channels + c]. It decodes only the lowest quarter of each
+// frame's bins through a quarter-size IMDCT, so it shows the stream
+// low-passed to an eighth of the sampling rate, at a fraction of the cost
+// of decoding. bucketSamples must be at least 4. Decoding stops once
+// bucketCount buckets are filled, and the last one may be short.
+DLLEXPORT int Atrac9GetOverview(unsigned char *pConfigData, const void *pBuffer, int size, int bucketSamples,
+	Atrac9OverviewBucket *pBuckets, int bucketCount, Atrac9OverviewReport *pReport);
+
+// Opens an .at9 file, a WAVE_FORMAT_EXTENSIBLE RIFF file with the ATRAC9
+// subformat. The file is memory mapped rather than read, and
+// Atrac9GetSuperframe points straight into the mapping for Atrac9Decode.
+// Only the superframes in the last few kilobytes are copied, into a padded
+// buffer that a corrupt frame can't read past. A data chunk cut short keeps
+// the whole superframes present. On Windows the path is in the ANSI code
+// page.
+DLLEXPORT int Atrac9OpenFile(const char *pPath, void **pFile);
+DLLEXPORT void Atrac9CloseFile(void* file);
+DLLEXPORT int Atrac9GetFileInfo(void* file, Atrac9FileInfo *pInfo);
+// Returns NULL past the last superframe
+DLLEXPORT const void* Atrac9GetSuperframe(void* file, int index);
+// Reads the header of an .at9 file that's already in memory. Superframe i
+// starts at dataOffset + i * superframeSize.
+DLLEXPORT int Atrac9ParseFile(const void *pBuffer, int size, Atrac9FileInfo *pInfo);
+
+// Sets the channel layout Atrac9Decode writes, such as WAVE order for
+// surround streams. Output channel i gets the stream's channel pMap[i], or
+// silence for -1, so channels can be reordered, duplicated or dropped.
+// count is the number of output channels. A NULL map restores the stream's
+// own order.
+DLLEXPORT int Atrac9SetChannelMap(void* handle, const int *pMap, int count);
+
+// Makes Atrac9Decode output PCM at outputRate, such as a mixer's fixed rate,
+// instead of the stream's rate. Set it after Atrac9InitDecoder, or to 0 to
+// turn resampling off. The fractional position carries over between frames,
+// so a frame gives a varying number of samples per channel, at most
+// frameSamples * outputRate / samplingRate + 1. Atrac9GetOutputSamples
+// returns the count from the last Atrac9Decode. The filter is longer when
+// downsampling, which delays the output by up to 65 stream samples. Its
+// state is allocated by the first call that turns resampling on and freed
+// with the handle. Mixers and Atrac9DecodeAccumulate don't resample, and
+// return an error for a handle that does.
+DLLEXPORT int Atrac9SetOutputRate(void* handle, int outputRate);
+DLLEXPORT int Atrac9GetOutputSamples(void* handle);
+
+// Makes Atrac9Decode output only the original samples of a stream, for
+// gapless playback. The first encoderDelay decoded samples are dropped, and
+// output stops sampleCount samples later, as given by Atrac9FileInfo. Set it
+// after Atrac9InitDecoder and before decoding the first frame. Each frame
+// then writes the samples it keeps to the start of pPcmBuffer, possibly
+// none, and Atrac9GetOutputSamples returns how many. When resampling, the
+// range is mapped to the output rate. A sampleCount of -1 keeps everything
+// past the delay, and with no delay turns trimming off. Mixers and
+// Atrac9DecodeAccumulate don't trim.
+DLLEXPORT int Atrac9SetTrim(void* handle, int encoderDelay, int sampleCount);
+
+// Makes Atrac9Decode play the samples from loopStart up to loopEnd over and
+// over, as given by Atrac9FileInfo. The points count from the end of the
+// encoder delay when trimming, so set it after Atrac9SetTrim, and before
+// decoding the first superframe. The superframe holding loopStart is decoded
+// once, and its PCM from loopStart on and the decoder state it leaves are
+// kept. The frame holding loopEnd is cut there and followed straight away
+// by the kept PCM, so it writes up to frameSamples * (framesInSuperframe + 1)
+// samples per channel, and Atrac9GetOutputSamples returns how many. The
+// rest of its superframe writes nothing, and decoding then carries on with
+// the superframe after the loop start's, which Atrac9GetNextSuperframe
+// returns. loopEnd has to be past the end of the loop start's superframe.
+// Looping can't be combined with resampling, and both points -1 turn it
+// off. The kept PCM and state are allocated by the first call that sets a
+// loop and freed with the handle. Mixers and Atrac9DecodeAccumulate don't
+// loop.
+DLLEXPORT int Atrac9SetLoop(void* handle, int loopStart, int loopEnd);
+// The superframe Atrac9Decode reads next while looping, or -1 otherwise
+DLLEXPORT int Atrac9GetNextSuperframe(void* handle);
+
+// Weights the spectrum of every channel before the IMDCT, for low-pass
+// occlusion, shelving or EQ at almost no extra cost. pGains holds either
+// ATRAC9_QUANT_UNIT_COUNT weights, one per quantization unit, or one weight
+// per frequency bin of a frame (frameSamples). The previous curve fades
+// linearly into the new one over transitionFrames frames. A NULL curve
+// fades back to unity and then stops filtering.
+DLLEXPORT int Atrac9SetSpectralGain(void* handle, const float *pGains, int count, int transitionFrames);
+
+// Makes Atrac9Decode measure each output channel while converting it, so
+// the levels come without another pass over the PCM. Atrac9GetMeter returns
+// the peak magnitude, sum of squares and number of samples outside the
+// 16-bit range for the last frame, in 16-bit units whatever the format.
+// RMS is sqrt(sumSquares / samples).
+DLLEXPORT int Atrac9SetMetering(void* handle, int enable);
+DLLEXPORT int Atrac9GetMeter(void* handle, Atrac9Meter *pMeter);
+
+// A mixer sums voices with the same frame size and sampling rate into a bus
+// and runs a single IMDCT per bus channel instead of one per voice channel.
+// Each frame, add one frame of every playing voice with Atrac9MixVoice,
+// then get the mix with Atrac9MixOutput. Voices have either the bus's
+// channel count or one channel, which is added to every bus channel. The
+// bus takes the rate of the first voice mixed after Atrac9InitMixer, and
+// voices at other rates are rejected. Handles fed to a mixer must only be
+// decoded through it.
+DLLEXPORT void* Atrac9GetMixer(void);
+DLLEXPORT void Atrac9ReleaseMixer(void* mixer);
+
+DLLEXPORT int Atrac9InitMixer(void* mixer, int channels, int frameSamples);
+DLLEXPORT int Atrac9MixVoice(void* mixer, void* handle, const void *pAtrac9Buffer, double gain, int *pNBytesUsed);
+DLLEXPORT int Atrac9MixOutput(void* mixer, void *pPcmBuffer, Atrac9Format format);
+
+// The instruction set used by every decoder in the process. It is detected
+// on the first Atrac9InitDecoder, or forced with the ATRAC9_SIMD environment
+// variable or Atrac9SetSimdLevel. Don't change it while decoding.
+DLLEXPORT int Atrac9SetSimdLevel(Atrac9SimdLevel level);
+DLLEXPORT Atrac9SimdLevel Atrac9GetSimdLevel(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status SetLoop(Atrac9Handle* handle, int loopStart, int loopEnd);
+int LoopOutput(Atrac9Handle* handle, int first, int count, const double** buffers);
+At9Status SkipLoopFrame(Atrac9Handle* handle, const void* audio, int* bytesUsed);
+int GetNextSuperframe(const Atrac9Handle* handle);
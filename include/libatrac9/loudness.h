@@ -0,0 +1,8 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status ScanLoudness(StreamContext* stream, unsigned char* configData, const unsigned char* buffer, int size,
+	double silenceThreshold, int minSilentFrames, double* envelope, int envelopeSize, SilentRegion* regions,
+	int regionCapacity, LoudnessReport* report);
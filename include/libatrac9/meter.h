@@ -0,0 +1,8 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+void SetMetering(Atrac9Handle* handle, int enabled);
+At9Status GetMeter(Atrac9Handle* handle, MeterInfo* info);
+PcmMeter* StartMeter(Frame* frame);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status InitMixer(Mixer* mixer, int channelCount, int frameSamples);
+At9Status MixVoice(Mixer* mixer, Atrac9Handle* handle, const void* audio, double gain, int* bytesUsed);
+
+At9Status MixOutputS16(Mixer* mixer, void* pcm);
+At9Status MixOutputS32(Mixer* mixer, void* pcm);
+At9Status MixOutputF32(Mixer* mixer, void* pcm);
+At9Status MixOutputF64(Mixer* mixer, void* pcm);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status GetOverview(StreamContext* stream, unsigned char* configData, const unsigned char* buffer, int size,
+	int bucketSamples, OverviewBucket* buckets, int bucketCapacity, OverviewReport* report);
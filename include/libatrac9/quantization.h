@@ -3,4 +3,3 @@
 #include "structures.h"
 
 void DequantizeSpectra(Block* block);
-void ScaleSpectrumBlock(Block* block);
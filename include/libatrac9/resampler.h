@@ -0,0 +1,13 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status SetOutputRate(Atrac9Handle* handle, int outputRate);
+int GetOutputSamples(Atrac9Handle* handle);
+int IsResampling(const Atrac9Handle* handle);
+
+void ResampleToS16(Atrac9Handle* handle, int16_t* pcmOut);
+void ResampleToS32(Atrac9Handle* handle, int32_t* pcmOut);
+void ResampleToF32(Atrac9Handle* handle, float* pcmOut);
+void ResampleToF64(Atrac9Handle* handle, double* pcmOut);
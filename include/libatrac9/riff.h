@@ -0,0 +1,9 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status ParseRiff(const unsigned char* buffer, size_t size, RiffInfo* info);
+At9Status OpenRiffFile(RiffFile* file, const char* path);
+void CloseRiffFile(RiffFile* file);
+const unsigned char* GetRiffSuperframe(const RiffFile* file, int index);
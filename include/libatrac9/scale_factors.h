@@ -5,3 +5,4 @@
 #include "structures.h"
 
 At9Status ReadScaleFactors(Channel* channel, BitReaderCxt* br);
+void ClearScaleFactors(Channel* channel, int count);
@@ -0,0 +1,230 @@
+#pragma once
+
+// Minimal vector abstraction over packed doubles. SIMD_WIDTH is the number
+// of doubles in a SimdDouble; the scalar fallback uses a width of 1.
+// SimdLoadInt32 and SimdLoadInt16 convert SIMD_WIDTH consecutive integers and
+// SimdReverse swaps the order of the lanes. SimdStoreRoundI32 stores each
+// lane rounded half up the way the PCM conversion always has, and
+// SimdStoreF32 stores each lane narrowed to a float.
+//
+// SimdInt holds SIMD_INT_WIDTH packed int32 values. Comparisons return all
+// ones in lanes where they hold and zero elsewhere. SimdLaneIndexI holds
+// each lane's own index.
+//
+// The instruction set is picked by SIMD_LEVEL. Files that don't define it
+// get the baseline the compiler targets. The DSP kernel files define it to
+// build one copy of the kernels per level; the integer ops are only
+// provided at the baseline levels.
+
+// Level values match Atrac9SimdLevel
+#define SIMD_LEVEL_SCALAR 1
+#define SIMD_LEVEL_SSE2 2
+#define SIMD_LEVEL_AVX2 3
+#define SIMD_LEVEL_AVX512 4
+#define SIMD_LEVEL_NEON 5
+
+#ifndef SIMD_LEVEL
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_LEVEL SIMD_LEVEL_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_LEVEL SIMD_LEVEL_NEON
+#else
+#define SIMD_LEVEL SIMD_LEVEL_SCALAR
+#endif
+#endif
+
+#if SIMD_LEVEL == SIMD_LEVEL_SSE2
+#include <emmintrin.h>
+
+#define SIMD_WIDTH 2
+typedef __m128d SimdDouble;
+
+#define SimdLoad(p) _mm_loadu_pd(p)
+#define SimdLoadInt32(p) _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(p)))
+#define SimdLoadInt16(p) _mm_setr_pd((p)[0], (p)[1])
+#define SimdStore(p, v) _mm_storeu_pd(p, v)
+#define SimdSet1(x) _mm_set1_pd(x)
+#define SimdZero() _mm_setzero_pd()
+#define SimdAdd(a, b) _mm_add_pd(a, b)
+#define SimdSub(a, b) _mm_sub_pd(a, b)
+#define SimdMul(a, b) _mm_mul_pd(a, b)
+#define SimdDiv(a, b) _mm_div_pd(a, b)
+#define SimdMax(a, b) _mm_max_pd(a, b)
+#define SimdReverse(a) _mm_shuffle_pd(a, a, 1)
+#define SimdStoreF32(p, v) _mm_storel_pi((__m64*)(p), _mm_cvtpd_ps(v))
+
+static inline void SimdStoreRoundI32(int* p, SimdDouble x)
+{
+	const __m128d biased = _mm_add_pd(x, _mm_set1_pd(0.5));
+	const __m128i truncated = _mm_cvttpd_epi32(biased);
+	const __m128d below = _mm_cmplt_pd(biased, _mm_cvtepi32_pd(truncated));
+	const __m128i borrow = _mm_shuffle_epi32(_mm_castpd_si128(below), _MM_SHUFFLE(3, 1, 2, 0));
+	_mm_storel_epi64((__m128i*)p, _mm_add_epi32(truncated, borrow));
+}
+
+#define SIMD_INT_WIDTH 4
+typedef __m128i SimdInt;
+
+#define SimdLoadI(p) _mm_loadu_si128((const __m128i*)(p))
+#define SimdStoreI(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define SimdSet1I(x) _mm_set1_epi32(x)
+#define SimdLaneIndexI() _mm_setr_epi32(0, 1, 2, 3)
+#define SimdAddI(a, b) _mm_add_epi32(a, b)
+#define SimdSubI(a, b) _mm_sub_epi32(a, b)
+#define SimdAndI(a, b) _mm_and_si128(a, b)
+#define SimdOrI(a, b) _mm_or_si128(a, b)
+#define SimdShiftRightI(a, n) _mm_sra_epi32(a, _mm_cvtsi32_si128(n))
+#define SimdCmpGtI(a, b) _mm_cmpgt_epi32(a, b)
+#define SimdSelectI(m, a, b) _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b))
+#define SimdMinI(a, b) SimdSelectI(_mm_cmpgt_epi32(a, b), b, a)
+#define SimdMaxI(a, b) SimdSelectI(_mm_cmpgt_epi32(a, b), a, b)
+
+#elif SIMD_LEVEL == SIMD_LEVEL_NEON
+#include <arm_neon.h>
+
+#define SIMD_WIDTH 2
+typedef float64x2_t SimdDouble;
+
+#define SimdLoad(p) vld1q_f64(p)
+#define SimdLoadInt32(p) vcvtq_f64_s64(vmovl_s32(vld1_s32(p)))
+#define SimdLoadInt16(p) vcvtq_f64_s64(vmovl_s32(vset_lane_s32((p)[1], vdup_n_s32((p)[0]), 1)))
+#define SimdStore(p, v) vst1q_f64(p, v)
+#define SimdSet1(x) vdupq_n_f64(x)
+#define SimdZero() vdupq_n_f64(0.0)
+#define SimdAdd(a, b) vaddq_f64(a, b)
+#define SimdSub(a, b) vsubq_f64(a, b)
+#define SimdMul(a, b) vmulq_f64(a, b)
+#define SimdDiv(a, b) vdivq_f64(a, b)
+#define SimdMax(a, b) vmaxq_f64(a, b)
+#define SimdReverse(a) vextq_f64(a, a, 1)
+#define SimdStoreF32(p, v) vst1_f32(p, vcvt_f32_f64(v))
+
+static inline void SimdStoreRoundI32(int* p, SimdDouble x)
+{
+	const float64x2_t biased = vaddq_f64(x, vdupq_n_f64(0.5));
+	const int32x2_t truncated = vqmovn_s64(vcvtq_s64_f64(biased));
+	const uint64x2_t below = vcltq_f64(biased, vcvtq_f64_s64(vmovl_s32(truncated)));
+	vst1_s32(p, vadd_s32(truncated, vreinterpret_s32_u32(vmovn_u64(below))));
+}
+
+#define SIMD_INT_WIDTH 4
+typedef int32x4_t SimdInt;
+
+#define SimdLoadI(p) vld1q_s32(p)
+#define SimdStoreI(p, v) vst1q_s32(p, v)
+#define SimdSet1I(x) vdupq_n_s32(x)
+#define SimdLaneIndexI() vcombine_s32(vcreate_s32(0x100000000ULL), vcreate_s32(0x300000002ULL))
+#define SimdAddI(a, b) vaddq_s32(a, b)
+#define SimdSubI(a, b) vsubq_s32(a, b)
+#define SimdAndI(a, b) vandq_s32(a, b)
+#define SimdOrI(a, b) vorrq_s32(a, b)
+#define SimdShiftRightI(a, n) vshlq_s32(a, vdupq_n_s32(-(n)))
+#define SimdCmpGtI(a, b) vreinterpretq_s32_u32(vcgtq_s32(a, b))
+#define SimdSelectI(m, a, b) vbslq_s32(vreinterpretq_u32_s32(m), a, b)
+#define SimdMinI(a, b) vminq_s32(a, b)
+#define SimdMaxI(a, b) vmaxq_s32(a, b)
+
+#elif SIMD_LEVEL == SIMD_LEVEL_AVX2
+#include <immintrin.h>
+
+#define SIMD_WIDTH 4
+typedef __m256d SimdDouble;
+
+#define SimdLoad(p) _mm256_loadu_pd(p)
+#define SimdLoadInt32(p) _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(p)))
+#define SimdLoadInt16(p) _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(p))))
+#define SimdStore(p, v) _mm256_storeu_pd(p, v)
+#define SimdSet1(x) _mm256_set1_pd(x)
+#define SimdZero() _mm256_setzero_pd()
+#define SimdAdd(a, b) _mm256_add_pd(a, b)
+#define SimdSub(a, b) _mm256_sub_pd(a, b)
+#define SimdMul(a, b) _mm256_mul_pd(a, b)
+#define SimdDiv(a, b) _mm256_div_pd(a, b)
+#define SimdMax(a, b) _mm256_max_pd(a, b)
+#define SimdReverse(a) _mm256_permute4x64_pd(a, _MM_SHUFFLE(0, 1, 2, 3))
+#define SimdStoreF32(p, v) _mm_storeu_ps(p, _mm256_cvtpd_ps(v))
+
+static inline void SimdStoreRoundI32(int* p, SimdDouble x)
+{
+	const __m256d biased = _mm256_add_pd(x, _mm256_set1_pd(0.5));
+	const __m128i truncated = _mm256_cvttpd_epi32(biased);
+	const __m256i below = _mm256_castpd_si256(_mm256_cmp_pd(biased, _mm256_cvtepi32_pd(truncated), _CMP_LT_OQ));
+	const __m256i borrow = _mm256_permutevar8x32_epi32(below, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+	_mm_storeu_si128((__m128i*)p, _mm_add_epi32(truncated, _mm256_castsi256_si128(borrow)));
+}
+
+#elif SIMD_LEVEL == SIMD_LEVEL_AVX512
+#include <immintrin.h>
+
+#define SIMD_WIDTH 8
+typedef __m512d SimdDouble;
+
+#define SimdLoad(p) _mm512_loadu_pd(p)
+#define SimdLoadInt32(p) _mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i*)(p)))
+#define SimdLoadInt16(p) _mm512_cvtepi32_pd(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(p))))
+#define SimdStore(p, v) _mm512_storeu_pd(p, v)
+#define SimdSet1(x) _mm512_set1_pd(x)
+#define SimdZero() _mm512_setzero_pd()
+#define SimdAdd(a, b) _mm512_add_pd(a, b)
+#define SimdSub(a, b) _mm512_sub_pd(a, b)
+#define SimdMul(a, b) _mm512_mul_pd(a, b)
+#define SimdDiv(a, b) _mm512_div_pd(a, b)
+#define SimdMax(a, b) _mm512_max_pd(a, b)
+#define SimdReverse(a) _mm512_permutexvar_pd(_mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7), a)
+#define SimdStoreF32(p, v) _mm256_storeu_ps(p, _mm512_cvtpd_ps(v))
+
+static inline void SimdStoreRoundI32(int* p, SimdDouble x)
+{
+	const __m512d biased = _mm512_add_pd(x, _mm512_set1_pd(0.5));
+	const __m512i truncated = _mm512_castsi256_si512(_mm512_cvttpd_epi32(biased));
+	const __mmask8 below = _mm512_cmp_pd_mask(biased, _mm512_cvtepi32_pd(_mm512_castsi512_si256(truncated)), _CMP_LT_OQ);
+	const __m512i rounded = _mm512_mask_sub_epi32(truncated, below, truncated, _mm512_set1_epi32(1));
+	_mm256_storeu_si256((__m256i*)p, _mm512_castsi512_si256(rounded));
+}
+
+#else
+
+#define SIMD_WIDTH 1
+typedef double SimdDouble;
+
+#define SimdLoad(p) (*(p))
+#define SimdLoadInt32(p) ((double)*(p))
+#define SimdLoadInt16(p) ((double)*(p))
+#define SimdStore(p, v) (*(p) = (v))
+#define SimdSet1(x) (x)
+#define SimdZero() 0.0
+#define SimdAdd(a, b) ((a) + (b))
+#define SimdSub(a, b) ((a) - (b))
+#define SimdMul(a, b) ((a) * (b))
+#define SimdDiv(a, b) ((a) / (b))
+#define SimdMax(a, b) ((a) > (b) ? (a) : (b))
+#define SimdReverse(a) (a)
+#define SimdStoreF32(p, v) (*(p) = (float)(v))
+
+static inline void SimdStoreRoundI32(int* p, SimdDouble x)
+{
+	x += 0.5;
+	*p = (int)x - (x < (int)x);
+}
+
+#define SIMD_INT_WIDTH 1
+typedef int SimdInt;
+
+#define SimdLoadI(p) (*(p))
+#define SimdStoreI(p, v) (*(p) = (v))
+#define SimdSet1I(x) (x)
+#define SimdLaneIndexI() 0
+#define SimdAddI(a, b) ((a) + (b))
+#define SimdSubI(a, b) ((a) - (b))
+#define SimdAndI(a, b) ((a) & (b))
+#define SimdOrI(a, b) ((a) | (b))
+#define SimdShiftRightI(a, n) ((a) >> (n))
+#define SimdCmpGtI(a, b) (-((a) > (b)))
+#define SimdSelectI(m, a, b) (((m) & (a)) | (~(m) & (b)))
+#define SimdMinI(a, b) ((a) > (b) ? (b) : (a))
+#define SimdMaxI(a, b) ((a) > (b) ? (a) : (b))
+
+#endif
+
+// n rounded up to a whole number of SimdInt vectors
+#define SimdRoundUpI(n) (((n) + SIMD_INT_WIDTH - 1) / SIMD_INT_WIDTH * SIMD_INT_WIDTH)
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status SetSpectralGain(Atrac9Handle* handle, const float* gains, int count, int transitionFrames);
+void ApplySpectralGain(Frame* frame, int channelCount);
+void AdvanceSpectralGain(Frame* frame);
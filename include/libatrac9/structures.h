@@ -1,5 +1,10 @@
 #pragma once
 
+#include "bit_reader.h"
+#include "error_codes.h"
+#include <stddef.h>
+#include <stdint.h>
+
 #define CONFIG_DATA_SIZE 4
 #define MAX_CHANNEL_COUNT 8
 #define MAX_BLOCK_COUNT 5
@@ -8,9 +13,38 @@
 #define MAX_BEX_VALUES 4
 
 #define MAX_QUANT_UNITS 30
+#define MAX_BAND_COUNT 18
+#define GRADIENT_PARAM_COUNT 7
+
+// An 11-bit frame size and up to 8 frames
+#define MAX_SUPERFRAME_BYTES (2048 * 8)
+#define MAX_SUPERFRAME_SAMPLES (MAX_FRAME_SAMPLES * 8)
+
+// The most samples per channel Atrac9Decode writes at the stream's rate,
+// from a frame that wraps a loop
+#define MAX_OUTPUT_SAMPLES (MAX_FRAME_SAMPLES + MAX_SUPERFRAME_SAMPLES)
+
+// A frame is only checked against the end of its superframe once it has
+// been read, so a corrupt one can read this far past it first: every
+// channel reading 32-bit coarse and fine values for each coefficient, plus
+// its headers.
+#define MAX_FRAME_OVERREAD (MAX_CHANNEL_COUNT * (MAX_FRAME_SAMPLES * 8 + 256))
+
+#define PADDED_SUPERFRAME_BYTES (MAX_SUPERFRAME_BYTES + MAX_FRAME_OVERREAD)
+
+// Starts a member on a cache line, which is also as wide as the widest
+// vector. Structs containing one must be allocated with that alignment.
+#define CACHE_LINE_SIZE 64
+#if defined(_MSC_VER)
+#define CACHE_ALIGNED __declspec(align(CACHE_LINE_SIZE))
+#else
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#endif
 
 typedef struct Frame_s Frame;
 typedef struct Block_s Block;
+typedef struct ChannelOutput_s ChannelOutput;
+typedef struct StreamStats_s StreamStats;
 
 typedef enum BlockType_e {
 	Mono = 0,
@@ -51,48 +85,64 @@ typedef struct RngCxt_s {
 } RngCxt;
 
 typedef struct Mdct_s {
+	CACHE_ALIGNED double imdctPrevious[MAX_FRAME_SAMPLES];
+	int imdctPreviousSilent;
 	int bits;
-	int size;
-	double scale;
-	double imdctPrevious[MAX_FRAME_SAMPLES];
-	double* window;
-	double* sinTable;
-	double* cosTable;
 } Mdct;
 
+// The per-frame working set comes first, with every coefficient array on
+// its own cache lines. The links set up by InitDecoder are kept at the end
+// so they don't share lines with it.
 typedef struct Channel_s {
-	Frame* frame;
-	Block* block;
-	ConfigData* config;
-	int channelIndex;
+	CACHE_ALIGNED double spectra[MAX_FRAME_SAMPLES];
 
-	Mdct mdct;
-
-	double pcm[MAX_FRAME_SAMPLES];
-	double spectra[MAX_FRAME_SAMPLES];
+	// Coarse and fine values are at most 16 bits wide
+	CACHE_ALIGNED int16_t quantizedSpectra[MAX_FRAME_SAMPLES];
+	CACHE_ALIGNED int16_t quantizedSpectraFine[MAX_FRAME_SAMPLES];
 
 	int codedQuantUnits;
 	int scaleFactorCodingMode;
 
+	// Entries at or past these counts in scaleFactors, quantizedSpectra and
+	// spectra are known to be zero, so only the difference from the previous
+	// frame needs clearing.
+	int scaleFactorCount;
+	int quantizedSpectraCount;
+	int spectraCount;
+
 	int scaleFactors[31];
 	int scaleFactorsPrev[31];
 
 	int precisions[MAX_QUANT_UNITS];
 	int precisionsFine[MAX_QUANT_UNITS];
 	int precisionMask[MAX_QUANT_UNITS];
+	int precisionsScaleFactors[MAX_QUANT_UNITS];
+	unsigned int precisionsSerial;
 
 	int codebookSet[MAX_QUANT_UNITS];
 
-	int quantizedSpectra[MAX_FRAME_SAMPLES];
-	int quantizedSpectraFine[MAX_FRAME_SAMPLES];
-
 	int bexMode;
 	int bexValueCount;
 	int bexValues[MAX_BEX_VALUES];
 
 	RngCxt Rng;
+
+	Frame* frame;
+	Block* block;
+	ConfigData* config;
+	// NULL when the frame is only unpacked
+	ChannelOutput* output;
+	int channelIndex;
 } Channel;
 
+// The PCM a channel decodes to and the overlap it carries into the next
+// frame. They live in the handle, leaving the frame with only what
+// unpacking and dequantizing need.
+struct ChannelOutput_s {
+	CACHE_ALIGNED double pcm[MAX_FRAME_SAMPLES];
+	Mdct mdct;
+};
+
 struct Block_s {
 	Frame* frame;
 	ConfigData* config;
@@ -111,7 +161,8 @@ struct Block_s {
 	int extensionUnit;
 	int quantizationUnitsPrev;
 
-	int gradient[31];
+	// Written up to the gradient end unit, which can be as high as 47
+	int gradient[48];
 	int gradientMode;
 	int gradientStartUnit;
 	int gradientStartValue;
@@ -127,22 +178,163 @@ struct Block_s {
 	int hasExtensionData;
 	int bexDataLength;
 	int bexMode;
+
+	int gradientParamsPrev[GRADIENT_PARAM_COUNT];
+	unsigned int allocationSerial;
 };
 
+// A per-bin gain applied to every channel's spectra before the IMDCT. A new
+// curve is reached by moving Current towards Target a step per frame.
+typedef struct SpectralGain_s {
+	CACHE_ALIGNED double Current[MAX_FRAME_SAMPLES];
+	CACHE_ALIGNED double Target[MAX_FRAME_SAMPLES];
+	int Enabled;
+	int FramesLeft;
+	// Bins at or past this are zero in both curves
+	int BinCount;
+	// Target is all ones, so the curve can be dropped once it's reached
+	int TargetIsUnity;
+} SpectralGain;
+
+// Levels of each output channel of the last frame Atrac9Decode wrote, in
+// 16-bit units whatever the format
+typedef struct PcmMeter_s {
+	double Peak[MAX_CHANNEL_COUNT];
+	double SumSquares[MAX_CHANNEL_COUNT];
+	// Samples outside the 16-bit range
+	int Clips[MAX_CHANNEL_COUNT];
+	int Enabled;
+} PcmMeter;
+
 struct Frame_s {
 	int IndexInSuperframe;
+	int IsSilent;
 	ConfigData* Config;
 	Channel* Channels[MAX_CHANNEL_COUNT];
 	Block Blocks[MAX_BLOCK_COUNT];
+	SpectralGain Gain;
+
+	// The channel written to each output channel, or -1 for silence
+	int ChannelMap[MAX_CHANNEL_COUNT];
+	int OutputChannelCount;
+	PcmMeter Meter;
+	// Filled in by the unpacker when set, while analyzing a stream
+	StreamStats* Stats;
 };
 
+// Decodes one frame up to the PCM of each channel, specialized for the
+// frame size and channel config
+typedef At9Status (*FrameDecoder)(Frame* frame, BitReaderCxt* br);
+
+// The taps when upsampling. Downsampling stretches the filter by the rate
+// ratio, up to 4 times as many taps for the lowest output rate. Tap counts
+// are a multiple of RESAMPLER_TAP_STEP, so half of one is a whole number of
+// the widest vectors.
+#define RESAMPLER_TAPS 32
+#define RESAMPLER_TAP_STEP 16
+#define MAX_RESAMPLER_TAPS (RESAMPLER_TAPS * 4)
+#define RESAMPLER_PHASES 64
+
+// Converts the decoded PCM to another sample rate. Output sample n sits
+// n * inputRate / outputRate input samples in, which is tracked exactly as
+// a whole position and a phase in units of 1 / outputRate.
+typedef struct Resampler_s {
+	// Windowed sinc filters of taps each for evenly spaced fractional
+	// positions. Filters in between are interpolated from the two nearest.
+	CACHE_ALIGNED double filter[(RESAMPLER_PHASES + 1) * MAX_RESAMPLER_TAPS];
+	// The last taps input samples of each channel, which the next frame
+	// follows
+	double history[MAX_CHANNEL_COUNT][MAX_RESAMPLER_TAPS];
+	int taps;
+	int enabled;
+	int inputRate;
+	int outputRate;
+	int position;
+	int phase;
+	int outputSamples;
+} Resampler;
+
+// The range of the decoded stream that Atrac9Decode outputs, from the end
+// of the encoder delay to the end of the original samples
+typedef struct Trim_s {
+	int enabled;
+	// In stream samples
+	long long start;
+	long long end;
+	// Output samples the decoder produced before the current frame,
+	// including the dropped ones
+	long long position;
+	int outputSamples;
+} Trim;
+
+// Plays a range of the stream over and over. The superframe holding the
+// loop start is decoded once, keeping its PCM from the loop start on and
+// the state it leaves, so each wrap carries on from the superframe after
+// it without decoding anything twice.
+typedef struct Loop_s {
+	// Room for the end of the frame that wraps, followed by the PCM kept
+	// from the loop start
+	CACHE_ALIGNED double pcm[MAX_CHANNEL_COUNT][MAX_OUTPUT_SAMPLES];
+	// The blocks as the loop start's superframe leaves them. Besides the
+	// scale factors and RNG, some unpacked parameters are only written when
+	// a frame codes them, so the blocks are kept whole.
+	Block blocks[MAX_BLOCK_COUNT];
+	// Each channel's overlap at the same point
+	Mdct mdct[MAX_CHANNEL_COUNT];
+	int enabled;
+	int captured;
+	// In stream samples, with the end exclusive
+	long long start;
+	long long end;
+	// Where the superframe after the loop start begins
+	long long resume;
+	// The stream sample the next frame starts at
+	long long position;
+	// Frames left in the superframe that wrapped, which aren't output
+	int skipFrames;
+	int outputSamples;
+} Loop;
+
 typedef struct Atrac9Handle_s {
 	int initialized;
 	int wlength;
 	ConfigData config;
+	FrameDecoder decodeFrame;
 	Frame frame;
+	ChannelOutput outputs[MAX_CHANNEL_COUNT];
+	// Allocated by the first Atrac9SetOutputRate that turns resampling on
+	Resampler* resampler;
+	Trim trim;
+	// Allocated by the first Atrac9SetLoop, as it's larger than the rest of
+	// the handle
+	Loop* loop;
 } Atrac9Handle;
 
+// A stream that is only unpacked or decoded up to its spectra, for the
+// scans that never produce PCM
+typedef struct StreamContext_s {
+	ConfigData config;
+	Frame frame;
+} StreamContext;
+
+// A bus that voices are summed into before the IMDCT. The transform and
+// the overlap-add are linear, so one IMDCT of the gain-weighted sum of the
+// voices' spectra gives the sum of their separately decoded outputs.
+typedef struct Mixer_s {
+	CACHE_ALIGNED double spectra[MAX_CHANNEL_COUNT][MAX_FRAME_SAMPLES];
+	CACHE_ALIGNED double pcm[MAX_CHANNEL_COUNT][MAX_FRAME_SAMPLES];
+	Mdct mdct[MAX_CHANNEL_COUNT];
+
+	// Bins at or past these counts are zero in the bus spectra
+	int spectraCount[MAX_CHANNEL_COUNT];
+
+	int channelCount;
+	int frameSamples;
+	// The rate of the first voice mixed, or 0 before it
+	int sampleRate;
+	int IsSilent;
+} Mixer;
+
 typedef struct BexGroup_s {
 	char GroupBUnit;
 	char GroupCUnit;
@@ -159,3 +351,85 @@ typedef struct CodecInfo_s {
 	int wlength;
 	unsigned char configData[CONFIG_DATA_SIZE];
 } CodecInfo;
+
+typedef struct MeterInfo_s {
+	int channels;
+	int samples;
+	double peak[MAX_CHANNEL_COUNT];
+	double sumSquares[MAX_CHANNEL_COUNT];
+	int clips[MAX_CHANNEL_COUNT];
+} MeterInfo;
+
+typedef struct ValidationReport_s {
+	int superframeSize;
+	int superframeCount;
+	int superframesChecked;
+	int failedSuperframe;
+	int failedFrame;
+	int error;
+} ValidationReport;
+
+struct StreamStats_s {
+	int frames;
+	int blocks;
+	int bandCount[MAX_BAND_COUNT + 1];
+	int stereoBand[MAX_BAND_COUNT + 1];
+	int extensionBand[MAX_BAND_COUNT + 1];
+	int bexMode[5];
+	int gradientMode[4];
+	int scaleFactorCodingMode[MAX_BLOCK_CHANNEL_COUNT][4];
+	int huffmanUnits[2][8];
+	int fixedLengthUnits;
+	long long spectraBits;
+	long long sideInfoBits;
+	long long paddingBits;
+};
+
+typedef struct SilentRegion_s {
+	int firstFrame;
+	int frameCount;
+} SilentRegion;
+
+typedef struct LoudnessReport_s {
+	int frames;
+	int frameSamples;
+	int samplingRate;
+	double integratedLoudness;
+	int silentRegionCount;
+	int failedSuperframe;
+	int error;
+} LoudnessReport;
+
+typedef struct OverviewBucket_s {
+	float min;
+	float max;
+	float rms;
+} OverviewBucket;
+
+typedef struct OverviewReport_s {
+	int channels;
+	int buckets;
+	int failedSuperframe;
+	int error;
+} OverviewReport;
+
+typedef struct RiffInfo_s {
+	CodecInfo codecInfo;
+	int sampleCount;
+	int encoderDelay;
+	int loopStart;
+	int loopEnd;
+	int dataOffset;
+	int dataSize;
+	int superframeCount;
+} RiffInfo;
+
+// A mapped .at9 file. The superframes near the end of the file are copied
+// into a zero-padded buffer, so a corrupt frame can't read past the mapping.
+typedef struct RiffFile_s {
+	RiffInfo info;
+	const unsigned char* data;
+	size_t size;
+	int firstTailSuperframe;
+	unsigned char tail[PADDED_SUPERFRAME_BYTES + MAX_FRAME_OVERREAD];
+} RiffFile;
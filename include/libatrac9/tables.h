@@ -19,8 +19,14 @@ extern const double QuantizerInverseStepSize[16];
 extern const double QuantizerStepSize[16];
 extern const double QuantizerFineStepSize[16];
 
-extern double MdctWindow[3][256];
-extern double ImdctWindow[3][256];
+extern double MdctWindow[5][256];
+extern double ImdctWindow[5][256];
 extern double SinTables[9][256];
 extern double CosTables[9][256];
-extern int ShuffleTables[9][256];
+extern double ImdctPostSin[5][128];
+extern double ImdctPostCos[5][128];
+extern int FftOrderTables[5][128];
+extern double FftTwiddleSin[8][3][32];
+extern double FftTwiddleCos[8][3][32];
+extern double QuantizerScaledStepSize[16][32];
+extern double QuantizerScaledFineStepSize[16][32];
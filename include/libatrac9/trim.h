@@ -0,0 +1,7 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status SetTrim(Atrac9Handle* handle, int encoderDelay, int sampleCount);
+int TrimOutput(Atrac9Handle* handle, int total, int* first);
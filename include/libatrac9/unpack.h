@@ -5,3 +5,4 @@
 #include "structures.h"
 
 At9Status UnpackFrame(Frame* frame, BitReaderCxt* br);
+void CalculateSpectrumCodebookIndex(Channel* channel);
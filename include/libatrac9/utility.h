@@ -7,6 +7,14 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+// For generic functions that are specialized by calling them with constant
+// arguments
+#if defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
 int Max(int a, int b);
 int Min(int a, int b);
 unsigned int BitReverse32(unsigned int value, int bitCount);
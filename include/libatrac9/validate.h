@@ -0,0 +1,9 @@
+#pragma once
+
+#include "error_codes.h"
+#include "structures.h"
+
+At9Status ValidateSuperframes(StreamContext* stream, unsigned char* configData, const unsigned char* buffer, int size,
+	int first, int count, ValidationReport* report, StreamStats* stats);
+const unsigned char* GetReadableSuperframe(const unsigned char* buffer, int size, int index, int superframeBytes,
+	unsigned char* padded);
@@ -1,4 +1,5 @@
 #include "band_extension.h"
+#include "dsp.h"
 #include "tables.h"
 #include "utility.h"
 #include <math.h>
@@ -6,11 +7,12 @@
 static void ApplyBandExtensionChannel(Channel* channel);
 
 static void ScaleBexQuantUnits(double* spectra, double* scales, int startUnit, int totalUnits);
+static void ScaleSpectra(double* spectra, int startBin, int endBin, double scale);
 static void FillHighFrequencies(double* spectra, int groupABin, int groupBBin, int groupCBin, int totalBins);
 static void AddNoiseToSpectrum(Channel* channel, int index, int count);
 
 static void RngInit(RngCxt* rng, unsigned short seed);
-static unsigned short RngNext(RngCxt* rng);
+static void RngFill(RngCxt* rng, int* output, int count);
 
 static const double BexMode0Bands3[5][32];
 static const double BexMode0Bands4[5][16];
@@ -20,6 +22,9 @@ static const double BexMode3Initial[16];
 static const double BexMode3Rate[16];
 static const double BexMode4Multiplier[8];
 
+// Mode 3 gain ramps, BexMode3Ramp[rate][i] = 2^(BexMode3Rate[rate] * (i + 1))
+static double BexMode3Ramp[16][MAX_FRAME_SAMPLES];
+
 void ApplyBandExtension(Block* block)
 {
 	if (!block->bandExtensionEnabled || !block->hasExtensionData) return;
@@ -54,7 +59,8 @@ static void ApplyBandExtensionChannel(Channel* channel)
 	FillHighFrequencies(spectra, groupABin, groupBBin, groupCBin, totalBins);
 
 	double groupAScale, groupBScale, groupCScale;
-	double rate, scale, mult;
+	double initial, mult;
+	const double* ramp;
 
 	switch (channel->bexMode)
 	{
@@ -101,24 +107,13 @@ static void ApplyBandExtensionChannel(Channel* channel)
 		groupAScale = BexMode2Scale[values[0]];
 		groupBScale = BexMode2Scale[values[1]];
 
-		for (int i = groupABin; i < groupBBin; i++)
-		{
-			spectra[i] *= groupAScale;
-		}
-
-		for (int i = groupBBin; i < groupCBin; i++)
-		{
-			spectra[i] *= groupBScale;
-		}
+		ScaleSpectra(spectra, groupABin, groupBBin, groupAScale);
+		ScaleSpectra(spectra, groupBBin, groupCBin, groupBScale);
 		return;
 	case 3:
-		rate = pow(2, BexMode3Rate[values[1]]);
-		scale = BexMode3Initial[values[0]];
-		for (int i = groupABin; i < totalBins; i++)
-		{
-			scale *= rate;
-			spectra[i] *= scale;
-		}
+		ramp = BexMode3Ramp[values[1]];
+		initial = BexMode3Initial[values[0]];
+		Dsp->ScaleSpectraRamp(&spectra[groupABin], ramp, totalBins - groupABin, initial);
 		return;
 	case 4:
 		mult = BexMode4Multiplier[values[0]];
@@ -126,50 +121,41 @@ static void ApplyBandExtensionChannel(Channel* channel)
 		groupBScale = 0.5011902 * mult;
 		groupCScale = 0.3548279 * mult;
 
-		for (int i = groupABin; i < groupBBin; i++)
-		{
-			spectra[i] *= groupAScale;
-		}
-
-		for (int i = groupBBin; i < groupCBin; i++)
-		{
-			spectra[i] *= groupBScale;
-		}
-
-		for (int i = groupCBin; i < totalBins; i++)
-		{
-			spectra[i] *= groupCScale;
-		}
+		ScaleSpectra(spectra, groupABin, groupBBin, groupAScale);
+		ScaleSpectra(spectra, groupBBin, groupCBin, groupBScale);
+		ScaleSpectra(spectra, groupCBin, totalBins, groupCScale);
 	}
 }
 
-static void ScaleBexQuantUnits(double* spectra, double* scales, int startUnit, int totalUnits)
+void GenerateBexTables()
 {
-	for (int i = startUnit; i < totalUnits; i++)
+	for (int rate = 0; rate < 16; rate++)
 	{
-		for (int k = QuantUnitToCoeffIndex[i]; k < QuantUnitToCoeffIndex[i + 1]; k++)
+		for (int i = 0; i < MAX_FRAME_SAMPLES; i++)
 		{
-			spectra[k] *= scales[i - startUnit];
+			BexMode3Ramp[rate][i] = pow(2, BexMode3Rate[rate] * (i + 1));
 		}
 	}
 }
 
-static void FillHighFrequencies(double* spectra, int groupABin, int groupBBin, int groupCBin, int totalBins)
+static void ScaleBexQuantUnits(double* spectra, double* scales, int startUnit, int totalUnits)
 {
-	for (int i = 0; i < groupBBin - groupABin; i++)
+	for (int i = startUnit; i < totalUnits; i++)
 	{
-		spectra[groupABin + i] = spectra[groupABin - i - 1];
+		ScaleSpectra(spectra, QuantUnitToCoeffIndex[i], QuantUnitToCoeffIndex[i + 1], scales[i - startUnit]);
 	}
+}
 
-	for (int i = 0; i < groupCBin - groupBBin; i++)
-	{
-		spectra[groupBBin + i] = spectra[groupBBin - i - 1];
-	}
+static void ScaleSpectra(double* spectra, int startBin, int endBin, double scale)
+{
+	Dsp->ScaleSpectra(&spectra[startBin], endBin - startBin, scale);
+}
 
-	for (int i = 0; i < totalBins - groupCBin; i++)
-	{
-		spectra[groupCBin + i] = spectra[groupCBin - i - 1];
-	}
+static void FillHighFrequencies(double* spectra, int groupABin, int groupBBin, int groupCBin, int totalBins)
+{
+	Dsp->MirrorSpectra(spectra, groupABin, groupBBin - groupABin);
+	Dsp->MirrorSpectra(spectra, groupBBin, groupCBin - groupBBin);
+	Dsp->MirrorSpectra(spectra, groupCBin, totalBins - groupCBin);
 }
 
 static void AddNoiseToSpectrum(Channel* channel, int index, int count)
@@ -180,10 +166,10 @@ static void AddNoiseToSpectrum(Channel* channel, int index, int count)
 		const unsigned short seed = (unsigned short)(543 * (sf[8] + sf[12] + sf[15] + 1));
 		RngInit(&channel->Rng, seed);
 	}
-	for (int i = 0; i < count; i++)
-	{
-		channel->spectra[i + index] = RngNext(&channel->Rng) / 65535.0 * 2.0 - 1.0;
-	}
+
+	int noise[MAX_FRAME_SAMPLES];
+	RngFill(&channel->Rng, noise, count);
+	Dsp->NoiseToSpectra(noise, &channel->spectra[index], count);
 }
 
 static void RngInit(RngCxt* rng, unsigned short seed)
@@ -197,14 +183,30 @@ static void RngInit(RngCxt* rng, unsigned short seed)
 	rng->initialized = TRUE;
 }
 
-static unsigned short RngNext(RngCxt* rng)
+// Each output feeds the next, so the generator itself stays serial. Keeping
+// the state in locals for the whole block avoids a round trip through the
+// context per value.
+static void RngFill(RngCxt* rng, int* output, int count)
 {
-	const unsigned short t = (unsigned short)(rng->stateD ^ (rng->stateD << 5));
-	rng->stateD = rng->stateC;
-	rng->stateC = rng->stateB;
-	rng->stateB = rng->stateA;
-	rng->stateA = (unsigned short)(t ^ rng->stateA ^ ((t ^ (rng->stateA >> 5)) >> 4));
-	return rng->stateA;
+	unsigned short a = rng->stateA;
+	unsigned short b = rng->stateB;
+	unsigned short c = rng->stateC;
+	unsigned short d = rng->stateD;
+
+	for (int i = 0; i < count; i++)
+	{
+		const unsigned short t = (unsigned short)(d ^ (d << 5));
+		d = c;
+		c = b;
+		b = a;
+		a = (unsigned short)(t ^ a ^ ((t ^ (a >> 5)) >> 4));
+		output[i] = a;
+	}
+
+	rng->stateA = a;
+	rng->stateB = b;
+	rng->stateC = c;
+	rng->stateD = d;
 }
 
 const BexGroup BexGroupInfo[8] =
@@ -1,12 +1,30 @@
 #include "bit_allocation.h"
+#include "simd.h"
 #include "tables.h"
 #include "utility.h"
 #include <string.h>
 
+// MAX_QUANT_UNITS rounded up to a whole number of vectors
+#define UNIT_BUFFER_SIZE 32
+
 static unsigned char GradientCurves[48][48];
 
+// The gradient and the allocation params it is built with are cached.
+// allocationSerial changes whenever they do, which lets each channel tell
+// whether its precisions are still current.
 At9Status CreateGradient(Block* block)
 {
+	const int params[GRADIENT_PARAM_COUNT] =
+	{
+		block->gradientMode, block->gradientStartUnit, block->gradientStartValue, block->gradientEndUnit,
+		block->gradientEndValue, block->gradientBoundary, block->quantizationUnitCount
+	};
+
+	if (memcmp(params, block->gradientParamsPrev, sizeof(params)) == 0) return ERR_SUCCESS;
+
+	memcpy(block->gradientParamsPrev, params, sizeof(params));
+	block->allocationSerial++;
+
 	int valueCount = block->gradientEndValue - block->gradientStartValue;
 	int unitCount = block->gradientEndUnit - block->gradientStartUnit;
 
@@ -45,79 +63,133 @@ At9Status CreateGradient(Block* block)
 	return ERR_SUCCESS;
 }
 
-void CalculateMask(Channel* channel)
+// Precisions only depend on the scale factors and the block's allocation
+// params, so they are kept while neither changes.
+void UpdatePrecisions(Channel* channel)
 {
-	memset(channel->precisionMask, 0, sizeof(channel->precisionMask));
-	for (int i = 1; i < channel->block->quantizationUnitCount; i++)
+	const Block* block = channel->block;
+	const size_t size = block->quantizationUnitCount * sizeof(int);
+
+	if (channel->precisionsSerial == block->allocationSerial &&
+		memcmp(channel->precisionsScaleFactors, channel->scaleFactors, size) == 0)
 	{
-		const int delta = channel->scaleFactors[i] - channel->scaleFactors[i - 1];
-		if (delta > 1)
-		{
-			channel->precisionMask[i] += Min(delta - 1, 5);
-		}
-		else if (delta < -1)
-		{
-			channel->precisionMask[i - 1] += Min(delta * -1 - 1, 5);
-		}
+		return;
 	}
+
+	channel->precisionsSerial = block->allocationSerial;
+	memcpy(channel->precisionsScaleFactors, channel->scaleFactors, size);
+
+	CalculateMask(channel);
+	CalculatePrecisions(channel);
 }
 
-void CalculatePrecisions(Channel* channel)
+// The mask of the vector of units whose scale factors start at sf[1]
+static FORCE_INLINE SimdInt CalculateMaskVector(const int* sf)
 {
-	Block* block = channel->block;
+	const SimdInt one = SimdSet1I(1);
+	const SimdInt five = SimdSet1I(5);
+	const SimdInt zero = SimdSet1I(0);
 
-	if (block->gradientMode != 0)
+	const SimdInt current = SimdLoadI(&sf[1]);
+	const SimdInt rise = SimdSubI(SimdSubI(current, SimdLoadI(&sf[0])), one);
+	const SimdInt fall = SimdSubI(SimdSubI(current, SimdLoadI(&sf[2])), one);
+	return SimdAddI(SimdMinI(SimdMaxI(rise, zero), five), SimdMinI(SimdMaxI(fall, zero), five));
+}
+
+// The scale factors are read from a local buffer with the edge values
+// repeated past either end. Whole vectors of the mask are stored in place,
+// and only the units past the last one go through a padded buffer.
+void CalculateMask(Channel* channel)
+{
+	const int unitCount = channel->block->quantizationUnitCount;
+	const int wholeCount = unitCount - unitCount % SIMD_INT_WIDTH;
+	int sf[UNIT_BUFFER_SIZE + 2];
+
+	// sf[i + 1] holds unit i, so the deltas across the ends add nothing
+	for (int i = 0; i < wholeCount; i += SIMD_INT_WIDTH)
 	{
-		for (int i = 0; i < block->quantizationUnitCount; i++)
-		{
-			channel->precisions[i] = channel->scaleFactors[i] + channel->precisionMask[i] - block->gradient[i];
-			if (channel->precisions[i] > 0)
-			{
-				switch (block->gradientMode)
-				{
-				case 1:
-					channel->precisions[i] /= 2;
-					break;
-				case 2:
-					channel->precisions[i] = 3 * channel->precisions[i] / 8;
-					break;
-				case 3:
-					channel->precisions[i] /= 4;
-					break;
-				}
-			}
-		}
+		SimdStoreI(&sf[i + 1], SimdLoadI(&channel->scaleFactors[i]));
 	}
-	else
+	for (int i = wholeCount; i < unitCount; i++)
 	{
-		for (int i = 0; i < block->quantizationUnitCount; i++)
-		{
-			channel->precisions[i] = channel->scaleFactors[i] - block->gradient[i];
-		}
+		sf[i + 1] = channel->scaleFactors[i];
 	}
-
-	for (int i = 0; i < block->quantizationUnitCount; i++)
+	sf[0] = channel->scaleFactors[0];
+	for (int i = unitCount + 1; i < SimdRoundUpI(unitCount) + 2; i++)
 	{
-		if (channel->precisions[i] < 1)
-		{
-			channel->precisions[i] = 1;
-		}
+		sf[i] = sf[i - 1];
 	}
 
-	for (int i = 0; i < block->gradientBoundary; i++)
+	for (int i = 0; i < wholeCount; i += SIMD_INT_WIDTH)
 	{
-		channel->precisions[i]++;
+		SimdStoreI(&channel->precisionMask[i], CalculateMaskVector(&sf[i]));
 	}
 
-	for (int i = 0; i < block->quantizationUnitCount; i++)
+	if (wholeCount == unitCount) return;
+
+	int mask[SIMD_INT_WIDTH];
+	SimdStoreI(mask, CalculateMaskVector(&sf[wholeCount]));
+	memcpy(&channel->precisionMask[wholeCount], mask, (unitCount - wholeCount) * sizeof(int));
+}
+
+// Modes 1-3 add the mask and scale positive precisions by 1/2, 3/8 and 1/4.
+// Precisions below one are raised to one anyway, so clamping at zero first
+// lets the division become a shift.
+static const int GradientModeUsesMask[4] = { 0, -1, -1, -1 };
+static const int GradientModeTriples[4] = { 0, 0, -1, 0 };
+static const int GradientModeShift[4] = { 0, 1, 3, 2 };
+
+// The precisions of the vector of units starting at first
+static FORCE_INLINE void CalculatePrecisionVector(const Block* block, int first, const int* sf, const int* mask,
+	const int* gradient, int* precisions, int* precisionsFine)
+{
+	const int mode = block->gradientMode;
+	const SimdInt index = SimdAddI(SimdSet1I(first), SimdLaneIndexI());
+	const SimdInt zero = SimdSet1I(0);
+	const SimdInt maxPrecision = SimdSet1I(15);
+
+	SimdInt precision = SimdLoadI(sf);
+	precision = SimdAddI(precision, SimdAndI(SimdLoadI(mask), SimdSet1I(GradientModeUsesMask[mode])));
+	precision = SimdSubI(precision, SimdLoadI(gradient));
+	precision = SimdMaxI(precision, zero);
+	precision = SimdAddI(precision, SimdAndI(SimdAddI(precision, precision), SimdSet1I(GradientModeTriples[mode])));
+	precision = SimdShiftRightI(precision, GradientModeShift[mode]);
+	precision = SimdMaxI(precision, SimdSet1I(1));
+	precision = SimdSubI(precision, SimdCmpGtI(SimdSet1I(block->gradientBoundary), index));
+
+	SimdStoreI(precisionsFine, SimdMaxI(SimdSubI(precision, maxPrecision), zero));
+	SimdStoreI(precisions, SimdMinI(precision, maxPrecision));
+}
+
+// Whole vectors of units are computed in place, and only the units past the
+// last one go through buffers padded to a vector
+void CalculatePrecisions(Channel* channel)
+{
+	const Block* block = channel->block;
+	const int unitCount = block->quantizationUnitCount;
+	const int wholeCount = unitCount - unitCount % SIMD_INT_WIDTH;
+
+	for (int i = 0; i < wholeCount; i += SIMD_INT_WIDTH)
 	{
-		channel->precisionsFine[i] = 0;
-		if (channel->precisions[i] > 15)
-		{
-			channel->precisionsFine[i] = channel->precisions[i] - 15;
-			channel->precisions[i] = 15;
-		}
+		CalculatePrecisionVector(block, i, &channel->scaleFactors[i], &channel->precisionMask[i], &block->gradient[i],
+			&channel->precisions[i], &channel->precisionsFine[i]);
 	}
+
+	if (wholeCount == unitCount) return;
+
+	const int tailCount = unitCount - wholeCount;
+	int sf[SIMD_INT_WIDTH] = { 0 };
+	int mask[SIMD_INT_WIDTH] = { 0 };
+	int gradient[SIMD_INT_WIDTH] = { 0 };
+	int precisions[SIMD_INT_WIDTH];
+	int precisionsFine[SIMD_INT_WIDTH];
+
+	memcpy(sf, &channel->scaleFactors[wholeCount], tailCount * sizeof(int));
+	memcpy(mask, &channel->precisionMask[wholeCount], tailCount * sizeof(int));
+	memcpy(gradient, &block->gradient[wholeCount], tailCount * sizeof(int));
+	CalculatePrecisionVector(block, wholeCount, sf, mask, gradient, precisions, precisionsFine);
+	memcpy(&channel->precisions[wholeCount], precisions, tailCount * sizeof(int));
+	memcpy(&channel->precisionsFine[wholeCount], precisionsFine, tailCount * sizeof(int));
 }
 
 static const unsigned char BaseCurve[48] =
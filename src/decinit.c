@@ -1,6 +1,9 @@
 #include "decinit.h"
+#include "band_extension.h"
 #include "bit_allocation.h"
 #include "bit_reader.h"
+#include "decoder.h"
+#include "dsp.h"
 #include "error_codes.h"
 #include "huffCodes.h"
 #include "structures.h"
@@ -9,34 +12,101 @@
 #include <math.h>
 #include <string.h>
 
-static At9Status InitConfigData(ConfigData* config, unsigned char * configData);
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 static At9Status ReadConfigData(ConfigData* config);
-static At9Status InitFrame(Atrac9Handle* handle);
+static At9Status InitFrame(Frame* frame, ConfigData* config);
 static At9Status InitBlock(Block* block, Frame* parentFrame, int blockIndex);
 static At9Status InitChannel(Channel* channel, Block* parentBlock, int channelIndex);
 static void InitHuffmanCodebooks();
 static void InitHuffmanSet(const HuffmanCodebook* codebooks, int count);
 static void GenerateTrigTables(int sizeBits);
-static void GenerateShuffleTable(int sizeBits);
-static void InitMdctTables(int frameSizePower);
+static void GenerateFftTables(int frameSizePower);
+static void GenerateTables(void);
+static void InitMdctTables(void);
 static void GenerateMdctWindow(int frameSizePower);
 static void GenerateImdctWindow(int frameSizePower);
+static void GenerateQuantizerTables();
 
 static int BlockTypeToChannelCount(BlockType blockType);
 
 At9Status InitDecoder(Atrac9Handle* handle, unsigned char* configData, int wlength)
 {
 	ERROR_CHECK(InitConfigData(&handle->config, configData));
-	ERROR_CHECK(InitFrame(handle));
-	InitMdctTables(handle->config.frameSamplesPower);
-	InitHuffmanCodebooks();
-	GenerateGradientCurves();
+	ERROR_CHECK(InitFrame(&handle->frame, &handle->config));
+
+	for (int ch = 0; ch < handle->config.channelCount; ch++)
+	{
+		handle->frame.Channels[ch]->output = &handle->outputs[ch];
+		handle->outputs[ch].mdct.bits = handle->config.frameSamplesPower;
+	}
+
+	handle->decodeFrame = GetFrameDecoder(&handle->config);
+	if (handle->resampler) handle->resampler->enabled = FALSE;
+	handle->trim.enabled = FALSE;
+	if (handle->loop)
+	{
+		handle->loop->enabled = FALSE;
+		handle->loop->skipFrames = 0;
+	}
+	SetChannelMap(handle, NULL, 0);
+	InitTables();
 	handle->wlength = wlength;
 	handle->initialized = 1;
 	return ERR_SUCCESS;
 }
 
-static At9Status InitConfigData(ConfigData* config, unsigned char* configData)
+At9Status InitStream(StreamContext* stream, unsigned char* configData)
+{
+	ERROR_CHECK(InitConfigData(&stream->config, configData));
+	ERROR_CHECK(InitFrame(&stream->frame, &stream->config));
+	InitTables();
+	return ERR_SUCCESS;
+}
+
+#ifdef _WIN32
+static INIT_ONCE TablesOnce = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK GenerateTablesOnce(PINIT_ONCE once, PVOID parameter, PVOID* context)
+{
+	(void)once;
+	(void)parameter;
+	(void)context;
+	GenerateTables();
+	return TRUE;
+}
+
+void InitTables(void)
+{
+	InitOnceExecuteOnce(&TablesOnce, GenerateTablesOnce, NULL, NULL);
+}
+#else
+static pthread_once_t TablesOnce = PTHREAD_ONCE_INIT;
+
+void InitTables(void)
+{
+	pthread_once(&TablesOnce, GenerateTables);
+}
+#endif
+
+// The tables cover every frame size, so they're the same for every stream
+// and no decoder ever writes them after this
+static void GenerateTables(void)
+{
+	InitDsp();
+	InitMdctTables();
+	InitHuffmanCodebooks();
+	GenerateGradientCurves();
+	GenerateQuantizerTables();
+	GenerateBexTables();
+}
+
+At9Status InitConfigData(ConfigData* config, unsigned char* configData)
 {
 	memcpy(config->configData, configData, CONFIG_DATA_SIZE);
 	ERROR_CHECK(ReadConfigData(config));
@@ -67,7 +137,7 @@ static At9Status ReadConfigData(ConfigData* config)
 	config->frameBytes = ReadInt(&br, 11) + 1;
 	config->superframeIndex = ReadInt(&br, 2);
 
-	if (header != 0xFE || validationBit != 0)
+	if (header != 0xFE || validationBit != 0 || config->channelConfigIndex >= 6)
 	{
 		return ERR_BAD_CONFIG_DATA;
 	}
@@ -75,19 +145,23 @@ static At9Status ReadConfigData(ConfigData* config)
 	return ERR_SUCCESS;
 }
 
-static At9Status InitFrame(Atrac9Handle* handle)
+static At9Status InitFrame(Frame* frame, ConfigData* config)
 {
-	const int blockCount = handle->config.channelConfig.blockCount;
-	handle->frame.Config = &handle->config;
+	const int blockCount = config->channelConfig.blockCount;
+	frame->Config = config;
+	frame->Gain.Enabled = FALSE;
+	frame->Gain.FramesLeft = 0;
+	frame->Meter.Enabled = FALSE;
+	frame->Stats = NULL;
 	int channelNum = 0;
 
 	for (int i = 0; i < blockCount; i++)
 	{
-		ERROR_CHECK(InitBlock(&handle->frame.Blocks[i], &handle->frame, i));
+		ERROR_CHECK(InitBlock(&frame->Blocks[i], frame, i));
 
-		for (int c = 0; c < handle->frame.Blocks[i].channelCount; c++)
+		for (int c = 0; c < frame->Blocks[i].channelCount; c++)
 		{
-			handle->frame.Channels[channelNum++] = &handle->frame.Blocks[i].channels[c];
+			frame->Channels[channelNum++] = &frame->Blocks[i].channels[c];
 		}
 	}
 
@@ -102,6 +176,9 @@ static At9Status InitBlock(Block* block, Frame* parentFrame, int blockIndex)
 	block->blockType = block->config->channelConfig.types[blockIndex];
 	block->channelCount = BlockTypeToChannelCount(block->blockType);
 
+	// No valid gradient has every param set to -1
+	memset(block->gradientParamsPrev, -1, sizeof(block->gradientParamsPrev));
+
 	for (int i = 0; i < block->channelCount; i++)
 	{
 		ERROR_CHECK(InitChannel(&block->channels[i], block, i));
@@ -115,8 +192,9 @@ static At9Status InitChannel(Channel* channel, Block* parentBlock, int channelIn
 	channel->block = parentBlock;
 	channel->frame = parentBlock->frame;
 	channel->config = parentBlock->config;
+	channel->output = NULL;
 	channel->channelIndex = channelIndex;
-	channel->mdct.bits = parentBlock->config->frameSamplesPower;
+	channel->precisionsSerial = parentBlock->allocationSerial - 1;
 	return ERR_SUCCESS;
 }
 
@@ -135,15 +213,21 @@ static void InitHuffmanSet(const HuffmanCodebook* codebooks, int count)
 	}
 }
 
-static void InitMdctTables(int frameSizePower)
+// Frames are 64 to 256 samples, and overviews run the IMDCT at a quarter
+// of the frame size
+static void InitMdctTables(void)
 {
 	for (int i = 0; i < 9; i++)
 	{
 		GenerateTrigTables(i);
-		GenerateShuffleTable(i);
 	}
-	GenerateMdctWindow(frameSizePower);
-	GenerateImdctWindow(frameSizePower);
+
+	for (int bits = 4; bits <= 8; bits++)
+	{
+		GenerateFftTables(bits);
+		GenerateMdctWindow(bits);
+		GenerateImdctWindow(bits);
+	}
 }
 
 static void GenerateTrigTables(int sizeBits)
@@ -160,21 +244,58 @@ static void GenerateTrigTables(int sizeBits)
 	}
 }
 
-static void GenerateShuffleTable(int sizeBits)
+static void GenerateFftTables(int frameSizePower)
 {
-	const int size = 1 << sizeBits;
-	int* table = ShuffleTables[sizeBits];
+	const int frameSize = 1 << frameSizePower;
+	const int fftSize = frameSize / 2;
+	int* order = FftOrderTables[frameSizePower - 4];
+	double* postSin = ImdctPostSin[frameSizePower - 4];
+	double* postCos = ImdctPostCos[frameSizePower - 4];
 
-	for (int i = 0; i < size; i++)
+	// The FFT runs radix-4 stages followed by a single radix-2 stage when
+	// needed, leaving each output at the digit-reversed index of its bin.
+	for (int i = 0; i < fftSize; i++)
+	{
+		int position = i;
+		int length = fftSize;
+		int multiplier = 1;
+		int bin = 0;
+
+		while (length > 1)
+		{
+			const int radix = length >= 4 ? 4 : 2;
+			const int quarter = length / radix;
+			bin += position / quarter * multiplier;
+			position %= quarter;
+			multiplier *= radix;
+			length = quarter;
+		}
+
+		order[i] = bin;
+		postSin[i] = sin(M_PI * bin / frameSize);
+		postCos[i] = cos(M_PI * bin / frameSize);
+	}
+
+	for (int blockSizeBits = 2; blockSizeBits < frameSizePower; blockSizeBits++)
 	{
-		table[i] = BitReverse32(i ^ (i / 2), sizeBits);
+		const int blockSize = 1 << blockSizeBits;
+
+		for (int m = 1; m <= 3; m++)
+		{
+			for (int j = 0; j < blockSize / 4; j++)
+			{
+				const double value = 2 * M_PI * m * j / blockSize;
+				FftTwiddleSin[blockSizeBits][m - 1][j] = sin(value);
+				FftTwiddleCos[blockSizeBits][m - 1][j] = cos(value);
+			}
+		}
 	}
 }
 
 static void GenerateMdctWindow(int frameSizePower)
 {
 	const int frameSize = 1 << frameSizePower;
-	double* mdct = MdctWindow[frameSizePower - 6];
+	double* mdct = MdctWindow[frameSizePower - 4];
 
 	for (int i = 0; i < frameSize; i++)
 	{
@@ -185,8 +306,8 @@ static void GenerateMdctWindow(int frameSizePower)
 static void GenerateImdctWindow(int frameSizePower)
 {
 	const int frameSize = 1 << frameSizePower;
-	double* imdct = ImdctWindow[frameSizePower - 6];
-	double* mdct = MdctWindow[frameSizePower - 6];
+	double* imdct = ImdctWindow[frameSizePower - 4];
+	double* mdct = MdctWindow[frameSizePower - 4];
 
 	for (int i = 0; i < frameSize; i++)
 	{
@@ -194,6 +315,20 @@ static void GenerateImdctWindow(int frameSizePower)
 	}
 }
 
+// Every spectrum scale is a power of two, so folding it into the step size
+// gives bit-identical results to scaling after dequantization.
+static void GenerateQuantizerTables()
+{
+	for (int precision = 0; precision < 16; precision++)
+	{
+		for (int sf = 0; sf < 32; sf++)
+		{
+			QuantizerScaledStepSize[precision][sf] = QuantizerStepSize[precision] * SpectrumScale[sf];
+			QuantizerScaledFineStepSize[precision][sf] = QuantizerFineStepSize[precision] * SpectrumScale[sf];
+		}
+	}
+}
+
 static int BlockTypeToChannelCount(BlockType blockType)
 {
 	switch (blockType)
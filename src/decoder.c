@@ -1,201 +1,571 @@
 #include "decoder.h"
 #include "band_extension.h"
 #include "bit_reader.h"
+#include "dsp.h"
 #include "imdct.h"
+#include "loop.h"
+#include "meter.h"
 #include "quantization.h"
+#include "resampler.h"
+#include "spectral_gain.h"
 #include "tables.h"
+#include "trim.h"
 #include "unpack.h"
+#include "utility.h"
 #include <stdint.h>
 #include <string.h>
 #include <limits.h>
 
 
-static At9Status DecodeFrame(Frame* frame, BitReaderCxt* br);
-static void ImdctBlock(Block* block);
-static void ApplyIntensityStereo(Block* block);
-static void PcmFloatToS16(Frame* frame, int16_t* pcmOut);
-static void PcmFloatToS32(Frame* frame, int32_t* pcmOut);
-static void PcmFloatToF32(Frame* frame, float* pcmOut);
-static void PcmFloatToF64(Frame* frame, double* pcmOut);
-
-static int16_t ClampS16(int32_t value)
-{
-	if (value > INT16_MAX)
-		return INT16_MAX;
-	if (value < INT16_MIN)
-		return INT16_MIN;
-	return (int16_t)value;
-}
-static int RoundDouble(double x)
-{
-	x += 0.5;
-	return (int)x - (x < (int)x);
-}
-
+static void PcmFloatToS16(Frame* frame, const double* const* buffers, int16_t* pcmOut, int sampleCount);
+static void PcmFloatToS32(Frame* frame, const double* const* buffers, int32_t* pcmOut, int sampleCount);
+static void PcmFloatToF32(Frame* frame, const double* const* buffers, float* pcmOut, int sampleCount);
+static void PcmFloatToF64(Frame* frame, const double* const* buffers, double* pcmOut, int sampleCount);
+static int GetOutputBuffers(Atrac9Handle* handle, const double** buffers);
+static int GetOutputPositions(const Frame* frame, int* positions);
+static void AccumulateSilentFrame(Frame* frame, float* pcm, double gain, double gainStep);
+static void AccumulateOutputChannels(const Frame* frame, float* pcm, const int* active, double gain,
+	double gainStep);
 
 At9Status DecodeS16(Atrac9Handle* handle, const void* audio, void* pcm, int* bytesUsed)
 {
+	if (handle->loop && handle->loop->skipFrames > 0) return SkipLoopFrame(handle, audio, bytesUsed);
+
 	BitReaderCxt br;
 	InitBitReaderCxt(&br, audio);
-	ERROR_CHECK(DecodeFrame(&handle->frame, &br));
+	ERROR_CHECK(handle->decodeFrame(&handle->frame, &br));
 
-	PcmFloatToS16(&handle->frame, (int16_t*)pcm);
+	if (IsResampling(handle))
+	{
+		ResampleToS16(handle, (int16_t*)pcm);
+	}
+	else
+	{
+		const double* buffers[MAX_CHANNEL_COUNT];
+		const int count = GetOutputBuffers(handle, buffers);
+		PcmFloatToS16(&handle->frame, buffers, (int16_t*)pcm, count);
+	}
 
 	*bytesUsed = br.Position / 8;
 	return ERR_SUCCESS;
 }
 At9Status DecodeS32(Atrac9Handle* handle, const void* audio, void* pcm, int* bytesUsed)
 {
+	if (handle->loop && handle->loop->skipFrames > 0) return SkipLoopFrame(handle, audio, bytesUsed);
+
 	BitReaderCxt br;
 	InitBitReaderCxt(&br, audio);
-	ERROR_CHECK(DecodeFrame(&handle->frame, &br));
+	ERROR_CHECK(handle->decodeFrame(&handle->frame, &br));
 
-	PcmFloatToS32(&handle->frame, (int32_t*)pcm);
+	if (IsResampling(handle))
+	{
+		ResampleToS32(handle, (int32_t*)pcm);
+	}
+	else
+	{
+		const double* buffers[MAX_CHANNEL_COUNT];
+		const int count = GetOutputBuffers(handle, buffers);
+		PcmFloatToS32(&handle->frame, buffers, (int32_t*)pcm, count);
+	}
 
 	*bytesUsed = br.Position / 8;
 	return ERR_SUCCESS;
 }
 At9Status DecodeF32(Atrac9Handle* handle, const void* audio, void* pcm, int* bytesUsed)
 {
+	if (handle->loop && handle->loop->skipFrames > 0) return SkipLoopFrame(handle, audio, bytesUsed);
+
 	BitReaderCxt br;
 	InitBitReaderCxt(&br, audio);
-	ERROR_CHECK(DecodeFrame(&handle->frame, &br));
+	ERROR_CHECK(handle->decodeFrame(&handle->frame, &br));
 
-	PcmFloatToF32(&handle->frame, (float*)pcm);
+	if (IsResampling(handle))
+	{
+		ResampleToF32(handle, (float*)pcm);
+	}
+	else
+	{
+		const double* buffers[MAX_CHANNEL_COUNT];
+		const int count = GetOutputBuffers(handle, buffers);
+		PcmFloatToF32(&handle->frame, buffers, (float*)pcm, count);
+	}
 
 	*bytesUsed = br.Position / 8;
 	return ERR_SUCCESS;
 }
 At9Status DecodeF64(Atrac9Handle* handle, const void* audio, void* pcm, int* bytesUsed)
 {
+	if (handle->loop && handle->loop->skipFrames > 0) return SkipLoopFrame(handle, audio, bytesUsed);
+
 	BitReaderCxt br;
 	InitBitReaderCxt(&br, audio);
-	ERROR_CHECK(DecodeFrame(&handle->frame, &br));
+	ERROR_CHECK(handle->decodeFrame(&handle->frame, &br));
 
-	PcmFloatToF64(&handle->frame, (double*)pcm);
+	if (IsResampling(handle))
+	{
+		ResampleToF64(handle, (double*)pcm);
+	}
+	else
+	{
+		const double* buffers[MAX_CHANNEL_COUNT];
+		const int count = GetOutputBuffers(handle, buffers);
+		PcmFloatToF64(&handle->frame, buffers, (double*)pcm, count);
+	}
 
 	*bytesUsed = br.Position / 8;
 	return ERR_SUCCESS;
 }
 
-static At9Status DecodeFrame(Frame* frame, BitReaderCxt* br)
+void PcmFloatToS16(Frame* frame, const double* const* buffers, int16_t* pcmOut, int sampleCount)
 {
-	ERROR_CHECK(UnpackFrame(frame, br));
+	const int channelCount = frame->OutputChannelCount;
+	const double* pcm[MAX_CHANNEL_COUNT];
+	PcmMeter* meter = StartMeter(frame);
 
-	for (int i = 0; i < frame->Config->channelConfig.blockCount; i++)
+	if (frame->IsSilent)
 	{
-		Block* block = &frame->Blocks[i];
+		memset(pcmOut, 0, channelCount * sampleCount * sizeof(*pcmOut));
+		return;
+	}
 
-		DequantizeSpectra(block);
-		ApplyIntensityStereo(block);
-		ScaleSpectrumBlock(block);
-		ApplyBandExtension(block);
-		ImdctBlock(block);
+	MapOutputChannels(frame, buffers, pcm);
+	Dsp->PcmToS16(pcm, channelCount, sampleCount, pcmOut, meter);
+}
+
+void PcmFloatToS32(Frame* frame, const double* const* buffers, int32_t* pcmOut, int sampleCount)
+{
+	const int channelCount = frame->OutputChannelCount;
+	const double* pcm[MAX_CHANNEL_COUNT];
+	PcmMeter* meter = StartMeter(frame);
+
+	if (frame->IsSilent)
+	{
+		memset(pcmOut, 0, channelCount * sampleCount * sizeof(*pcmOut));
+		return;
 	}
 
-	return ERR_SUCCESS;
+	MapOutputChannels(frame, buffers, pcm);
+	Dsp->PcmToS32(pcm, channelCount, sampleCount, pcmOut, meter);
 }
 
-void PcmFloatToS16(Frame* frame, int16_t* pcmOut)
+void PcmFloatToF32(Frame* frame, const double* const* buffers, float* pcmOut, int sampleCount)
 {
-	const int channelCount = frame->Config->channelCount;
-	const int sampleCount = frame->Config->frameSamples;
-	Channel** channels = frame->Channels;
-	int i = 0;
+	const int channelCount = frame->OutputChannelCount;
+	const double* pcm[MAX_CHANNEL_COUNT];
+	PcmMeter* meter = StartMeter(frame);
 
-	for (int smpl = 0; smpl < sampleCount; smpl++)
+	if (frame->IsSilent)
 	{
-		for (int ch = 0; ch < channelCount; ch++, i++)
-		{
-			pcmOut[i] = ClampS16(RoundDouble(channels[ch]->pcm[smpl]));
-		}
+		memset(pcmOut, 0, channelCount * sampleCount * sizeof(*pcmOut));
+		return;
 	}
+
+	MapOutputChannels(frame, buffers, pcm);
+	Dsp->PcmToF32(pcm, channelCount, sampleCount, pcmOut, meter);
 }
 
-void PcmFloatToS32(Frame* frame, int32_t* pcmOut)
+void PcmFloatToF64(Frame* frame, const double* const* buffers, double* pcmOut, int sampleCount)
 {
-	const int channelCount = frame->Config->channelCount;
-	const int sampleCount = frame->Config->frameSamples;
-	Channel** channels = frame->Channels;
-	int i = 0;
+	const int channelCount = frame->OutputChannelCount;
+	const double* pcm[MAX_CHANNEL_COUNT];
+	PcmMeter* meter = StartMeter(frame);
 
-	for (int smpl = 0; smpl < sampleCount; smpl++)
+	if (frame->IsSilent)
 	{
-		for (int ch = 0; ch < channelCount; ch++, i++)
-		{
-			pcmOut[i] = RoundDouble(channels[ch]->pcm[smpl]);
-		}
+		memset(pcmOut, 0, channelCount * sampleCount * sizeof(*pcmOut));
+		return;
 	}
+
+	MapOutputChannels(frame, buffers, pcm);
+	Dsp->PcmToF64(pcm, channelCount, sampleCount, pcmOut, meter);
 }
 
-void PcmFloatToF32(Frame* frame, float* pcmOut)
+// Trimming starts the output part way into the frame, and a frame that
+// wraps a loop goes on with the loop start, so the conversion kernels take
+// a buffer per channel starting at the first sample written
+static int GetOutputBuffers(Atrac9Handle* handle, const double** buffers)
 {
-	const int channelCount = frame->Config->channelCount;
-	const int sampleCount = frame->Config->frameSamples;
-	Channel** channels = frame->Channels;
-	int i = 0;
+	int first;
+	const int count = TrimOutput(handle, handle->config.frameSamples, &first);
 
-	for (int smpl = 0; smpl < sampleCount; smpl++)
+	for (int ch = 0; ch < handle->config.channelCount; ch++)
 	{
-		for (int ch = 0; ch < channelCount; ch++, i++)
-		{
-			pcmOut[i] = (float)channels[ch]->pcm[smpl];
-		}
+		buffers[ch] = &handle->outputs[ch].pcm[first];
 	}
+
+	return handle->loop && handle->loop->enabled ? LoopOutput(handle, first, count, buffers) : count;
 }
 
-void PcmFloatToF64(Frame* frame, double* pcmOut)
+// Puts the buffers of the frame's channels in output channel order. The
+// interleaving kernels take a buffer per output channel, so reordering,
+// duplicating or dropping channels costs nothing.
+void MapOutputChannels(const Frame* frame, const double* const* buffers, const double** pcm)
 {
-	const int channelCount = frame->Config->channelCount;
-	const int sampleCount = frame->Config->frameSamples;
-	Channel** channels = frame->Channels;
-	int i = 0;
+	static const double silence[MAX_OUTPUT_SAMPLES];
+
+	for (int i = 0; i < frame->OutputChannelCount; i++)
+	{
+		const int source = frame->ChannelMap[i];
+		pcm[i] = source < 0 ? silence : buffers[source];
+	}
+}
+
+At9Status SetChannelMap(Atrac9Handle* handle, const int* map, int count)
+{
+	Frame* frame = &handle->frame;
+	const int channelCount = handle->config.channelCount;
 
-	for (int smpl = 0; smpl < sampleCount; smpl++)
+	if (!map)
 	{
-		for (int ch = 0; ch < channelCount; ch++, i++)
+		for (int i = 0; i < channelCount; i++)
 		{
-			pcmOut[i] = channels[ch]->pcm[smpl];
+			frame->ChannelMap[i] = i;
 		}
+		frame->OutputChannelCount = channelCount;
+		return ERR_SUCCESS;
 	}
+
+	if (count < 1 || count > MAX_CHANNEL_COUNT) return ERR_CHANNEL_MAP_INVALID;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (map[i] < -1 || map[i] >= channelCount) return ERR_CHANNEL_MAP_INVALID;
+	}
+
+	memcpy(frame->ChannelMap, map, count * sizeof(int));
+	frame->OutputChannelCount = count;
+	return ERR_SUCCESS;
 }
 
-static void ImdctBlock(Block* block)
+static int GetActiveBinCount(const double* spectra, int count)
 {
-	for (int i = 0; i < block->channelCount; i++)
+	while (count > 0 && spectra[count - 1] == 0)
 	{
-		Channel* channel = &block->channels[i];
+		count--;
+	}
+	return count;
+}
 
-		RunImdct(&channel->mdct, channel->spectra, channel->pcm);
+static FORCE_INLINE void UpdateSpectraCounts(Frame* frame, int frameSamples, int channelCount)
+{
+	for (int i = 0; i < channelCount; i++)
+	{
+		Channel* channel = frame->Channels[i];
+		channel->spectraCount = GetActiveBinCount(channel->spectra, frameSamples);
 	}
 }
 
-static void ApplyIntensityStereo(Block* block)
+typedef struct ImdctGroup_s {
+	int count;
+	int binCount;
+	int channels[MAX_CHANNEL_COUNT];
+	Mdct* mdcts[MAX_CHANNEL_COUNT];
+	double* spectra[MAX_CHANNEL_COUNT];
+	double* pcm[MAX_CHANNEL_COUNT];
+} ImdctGroup;
+
+// Channels whose spectra end in the lowest eighth, such as LFE, are
+// batched separately so the wide channels don't cancel their pruning.
+static FORCE_INLINE void GroupChannels(Frame* frame, int frameSamples, int channelCount, ImdctGroup* groups)
 {
-	if (block->blockType != Stereo) return;
+	groups[0].count = groups[0].binCount = 0;
+	groups[1].count = groups[1].binCount = 0;
+
+	for (int i = 0; i < channelCount; i++)
+	{
+		Channel* channel = frame->Channels[i];
+		const int binCount = channel->spectraCount;
+		ImdctGroup* group = &groups[binCount <= frameSamples / 8];
+
+		group->channels[group->count] = i;
+		group->mdcts[group->count] = &channel->output->mdct;
+		group->spectra[group->count] = channel->spectra;
+		group->pcm[group->count] = channel->output->pcm;
+		group->binCount = Max(group->binCount, binCount);
+		group->count++;
+	}
+}
 
-	const int totalUnits = block->quantizationUnitCount;
-	const int stereoUnits = block->stereoQuantizationUnit;
-	if (stereoUnits >= totalUnits) return;
+static FORCE_INLINE void ImdctFrame(Frame* frame, int frameSamples, int channelCount)
+{
+	ImdctGroup groups[2];
+	GroupChannels(frame, frameSamples, channelCount, groups);
 
-	Channel* source = &block->channels[block->primaryChannelIndex == 0 ? 0 : 1];
-	Channel* dest = &block->channels[block->primaryChannelIndex == 0 ? 1 : 0];
+	for (int i = 0; i < 2; i++)
+	{
+		if (groups[i].count == 0) continue;
+		RunImdctBatch(groups[i].mdcts, groups[i].spectra, groups[i].pcm, groups[i].count, groups[i].binCount);
+	}
+}
 
-	for (int i = stereoUnits; i < totalUnits; i++)
+// A frame is silent when nothing was coded in any channel and no band
+// extension mode synthesizes noise above the coded range.
+static FORCE_INLINE int IsFrameSilent(Frame* frame, int blockCount)
+{
+	for (int i = 0; i < blockCount; i++)
 	{
-		const int sign = block->jointStereoSigns[i];
-		for (int sb = QuantUnitToCoeffIndex[i]; sb < QuantUnitToCoeffIndex[i + 1]; sb++)
+		Block* block = &frame->Blocks[i];
+		const int bexApplied = block->bandExtensionEnabled && block->hasExtensionData;
+
+		for (int j = 0; j < block->channelCount; j++)
 		{
-			if (sign > 0)
+			Channel* channel = &block->channels[j];
+			const int binCount = QuantUnitToCoeffIndex[channel->codedQuantUnits];
+
+			if (bexApplied && channel->bexMode < 2) return FALSE;
+
+			for (int k = 0; k < binCount; k++)
 			{
-				dest->spectra[sb] = -source->spectra[sb];
+				if (channel->quantizedSpectra[k]) return FALSE;
 			}
-			else
+
+			for (int k = 0; k < channel->codedQuantUnits; k++)
 			{
-				dest->spectra[sb] = source->spectra[sb];
+				if (channel->precisionsFine[k] == 0) continue;
+
+				for (int sb = QuantUnitToCoeffIndex[k]; sb < QuantUnitToCoeffIndex[k + 1]; sb++)
+				{
+					if (channel->quantizedSpectraFine[sb]) return FALSE;
+				}
 			}
 		}
 	}
+
+	return TRUE;
+}
+
+static FORCE_INLINE void ImdctSilentFrame(Frame* frame, int channelCount)
+{
+	int isSilent = TRUE;
+
+	for (int i = 0; i < channelCount; i++)
+	{
+		Channel* channel = frame->Channels[i];
+		isSilent &= channel->output->mdct.imdctPreviousSilent;
+
+		memset(channel->spectra, 0, channel->spectraCount * sizeof(double));
+		channel->spectraCount = 0;
+		RunImdctSilent(&channel->output->mdct, channel->output->pcm);
+	}
+
+	frame->IsSilent = isSilent;
+}
+
+static FORCE_INLINE At9Status DecodeFrame(Frame* frame, BitReaderCxt* br, int frameSamples, int blockCount, int channelCount)
+{
+	ERROR_CHECK(UnpackFrame(frame, br));
+
+	if (IsFrameSilent(frame, blockCount))
+	{
+		ImdctSilentFrame(frame, channelCount);
+		if (frame->Gain.Enabled) AdvanceSpectralGain(frame);
+		return ERR_SUCCESS;
+	}
+
+	frame->IsSilent = 0;
+
+	for (int i = 0; i < blockCount; i++)
+	{
+		Block* block = &frame->Blocks[i];
+
+		DequantizeSpectra(block);
+		ApplyBandExtension(block);
+	}
+
+	UpdateSpectraCounts(frame, frameSamples, channelCount);
+	if (frame->Gain.Enabled) ApplySpectralGain(frame, channelCount);
+
+	ImdctFrame(frame, frameSamples, channelCount);
+
+	return ERR_SUCCESS;
+}
+
+// Decodes a frame up to the spectra of each channel, leaving the IMDCT and
+// the channels' overlap untouched. The spectra are only valid when the frame
+// isn't silent. Band extension can be skipped when only the lower bins are
+// needed.
+At9Status DecodeSpectra(Frame* frame, const void* audio, int bandExtension, int* isSilent, int* bytesUsed)
+{
+	const ConfigData* config = frame->Config;
+	const int blockCount = config->channelConfig.blockCount;
+	const int frameSamples = config->frameSamples;
+	BitReaderCxt br;
+	InitBitReaderCxt(&br, audio);
+	ERROR_CHECK(UnpackFrame(frame, &br));
+
+	*bytesUsed = br.Position / 8;
+	*isSilent = IsFrameSilent(frame, blockCount);
+	if (*isSilent)
+	{
+		if (frame->Gain.Enabled) AdvanceSpectralGain(frame);
+		return ERR_SUCCESS;
+	}
+
+	for (int i = 0; i < blockCount; i++)
+	{
+		Block* block = &frame->Blocks[i];
+
+		DequantizeSpectra(block);
+		if (bandExtension) ApplyBandExtension(block);
+	}
+
+	UpdateSpectraCounts(frame, frameSamples, config->channelCount);
+	if (frame->Gain.Enabled) ApplySpectralGain(frame, config->channelCount);
+
+	return ERR_SUCCESS;
+}
+
+// The window and overlap stage of the IMDCT adds each sample straight into
+// the interleaved output, so the frame's PCM is never stored. That needs
+// every channel of the stream in exactly one output channel, and channel
+// maps that drop or duplicate some go through the frame's PCM instead.
+At9Status DecodeAccumulateF32(Atrac9Handle* handle, const void* audio, float* pcm, double gainStart, double gainEnd,
+	int* bytesUsed)
+{
+	Frame* frame = &handle->frame;
+	const int channelCount = handle->config.channelCount;
+	const int frameSamples = handle->config.frameSamples;
+	const double gainStep = (gainEnd - gainStart) / frameSamples;
+	int positions[MAX_CHANNEL_COUNT];
+	int isSilent;
+
+	// The PCM is added at the stream's rate
+	if (IsResampling(handle)) return ERR_RESAMPLER_UNSUPPORTED;
+
+	ERROR_CHECK(DecodeSpectra(frame, audio, TRUE, &isSilent, bytesUsed));
+
+	if (isSilent)
+	{
+		AccumulateSilentFrame(frame, pcm, gainStart, gainStep);
+		return ERR_SUCCESS;
+	}
+
+	if (!GetOutputPositions(frame, positions))
+	{
+		ImdctFrame(frame, frameSamples, channelCount);
+		AccumulateOutputChannels(frame, pcm, NULL, gainStart, gainStep);
+		return ERR_SUCCESS;
+	}
+
+	ImdctGroup groups[2];
+	GroupChannels(frame, frameSamples, channelCount, groups);
+
+	for (int i = 0; i < 2; i++)
+	{
+		float* outputs[MAX_CHANNEL_COUNT];
+		if (groups[i].count == 0) continue;
+
+		for (int ch = 0; ch < groups[i].count; ch++)
+		{
+			outputs[ch] = &pcm[positions[groups[i].channels[ch]]];
+		}
+
+		RunImdctBatchAccumulate(groups[i].mdcts, groups[i].spectra, outputs, frame->OutputChannelCount,
+			groups[i].count, groups[i].binCount, gainStart, gainStep);
+	}
+
+	return ERR_SUCCESS;
+}
+
+// Finds the output channel of each channel of the stream. Returns FALSE when
+// the channel map drops or duplicates any of them.
+static int GetOutputPositions(const Frame* frame, int* positions)
+{
+	const int channelCount = frame->Config->channelCount;
+	int found = 0;
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		positions[ch] = -1;
+	}
+
+	for (int i = 0; i < frame->OutputChannelCount; i++)
+	{
+		const int source = frame->ChannelMap[i];
+		if (source < 0) continue;
+		if (positions[source] >= 0) return FALSE;
+
+		positions[source] = i;
+		found++;
+	}
+
+	return found == channelCount;
+}
+
+// A silent frame only adds what's left of the previous frame's overlap
+static void AccumulateSilentFrame(Frame* frame, float* pcm, double gain, double gainStep)
+{
+	int active[MAX_CHANNEL_COUNT];
+
+	for (int ch = 0; ch < frame->Config->channelCount; ch++)
+	{
+		ChannelOutput* channel = frame->Channels[ch]->output;
+		active[ch] = !channel->mdct.imdctPreviousSilent;
+		if (active[ch]) RunImdctSilent(&channel->mdct, channel->pcm);
+	}
+
+	AccumulateOutputChannels(frame, pcm, active, gain, gainStep);
+}
+
+// Adds the PCM of the channels that are active, or of all of them when
+// active is NULL, to the output channels the channel map puts them in
+static void AccumulateOutputChannels(const Frame* frame, float* pcm, const int* active, double gain,
+	double gainStep)
+{
+	const int channelCount = frame->OutputChannelCount;
+	const int sampleCount = frame->Config->frameSamples;
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		const int source = frame->ChannelMap[ch];
+		if (source < 0 || (active && !active[source])) continue;
+
+		const double* input = frame->Channels[source]->output->pcm;
+
+		for (int i = 0; i < sampleCount; i++)
+		{
+			float* output = &pcm[i * channelCount + ch];
+			*output = (float)(*output + (gain + gainStep * i) * input[i]);
+		}
+	}
+}
+
+// One DecodeFrame specialization per frame size and channel config, with the
+// block and channel counts of ChannelConfigs as constants
+#define FRAME_DECODER(power, config, blockCount, channelCount) \
+	static At9Status DecodeFrame##power##_##config(Frame* frame, BitReaderCxt* br) \
+	{ \
+		return DecodeFrame(frame, br, 1 << power, blockCount, channelCount); \
+	}
+
+#define FRAME_DECODERS(power) \
+	FRAME_DECODER(power, 0, 1, 1) \
+	FRAME_DECODER(power, 1, 2, 2) \
+	FRAME_DECODER(power, 2, 1, 2) \
+	FRAME_DECODER(power, 3, 4, 6) \
+	FRAME_DECODER(power, 4, 5, 8) \
+	FRAME_DECODER(power, 5, 2, 4)
+
+FRAME_DECODERS(6)
+FRAME_DECODERS(7)
+FRAME_DECODERS(8)
+
+#define FRAME_DECODER_ROW(power) \
+	{ \
+		DecodeFrame##power##_0, DecodeFrame##power##_1, DecodeFrame##power##_2, \
+		DecodeFrame##power##_3, DecodeFrame##power##_4, DecodeFrame##power##_5 \
+	}
+
+static const FrameDecoder FrameDecoders[3][6] =
+{
+	FRAME_DECODER_ROW(6),
+	FRAME_DECODER_ROW(7),
+	FRAME_DECODER_ROW(8),
+};
+
+FrameDecoder GetFrameDecoder(const ConfigData* config)
+{
+	return FrameDecoders[config->frameSamplesPower - 6][config->channelConfigIndex];
 }
 
 int GetCodecInfo(Atrac9Handle* handle, CodecInfo * pCodecInfo)
@@ -0,0 +1,139 @@
+#include "dsp.h"
+#include "simd.h"
+#include "utility.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && defined(DSP_X86)
+#include <intrin.h>
+#endif
+
+static const DspKernels* GetKernels(int level);
+static int GetSupportedLevel(void);
+static int GetRequestedLevel(void);
+
+const DspKernels* Dsp =
+#if SIMD_LEVEL == SIMD_LEVEL_SSE2
+	&DspKernelsSse2;
+#elif SIMD_LEVEL == SIMD_LEVEL_NEON
+	&DspKernelsNeon;
+#else
+	&DspKernelsScalar;
+#endif
+
+static int DspResolved;
+
+void InitDsp(void)
+{
+	if (DspResolved) return;
+
+	if (!SetDspLevel(GetRequestedLevel()))
+	{
+		SetDspLevel(DSP_LEVEL_AUTO);
+	}
+}
+
+int SetDspLevel(int level)
+{
+	const int supported = GetSupportedLevel();
+
+	if (level == DSP_LEVEL_AUTO)
+	{
+		level = supported;
+	}
+
+	const DspKernels* kernels = GetKernels(level);
+	if (!kernels || level > supported) return FALSE;
+
+	Dsp = kernels;
+	DspResolved = TRUE;
+	return TRUE;
+}
+
+int GetDspLevel(void)
+{
+	InitDsp();
+	return Dsp->Level;
+}
+
+static const DspKernels* GetKernels(int level)
+{
+	switch (level)
+	{
+	case SIMD_LEVEL_SCALAR:
+		return &DspKernelsScalar;
+#ifdef DSP_X86
+	case SIMD_LEVEL_SSE2:
+		return &DspKernelsSse2;
+	case SIMD_LEVEL_AVX2:
+		return &DspKernelsAvx2;
+	case SIMD_LEVEL_AVX512:
+		return &DspKernelsAvx512;
+#endif
+#ifdef DSP_ARM64
+	case SIMD_LEVEL_NEON:
+		return &DspKernelsNeon;
+#endif
+	default:
+		return NULL;
+	}
+}
+
+// The highest level usable on this CPU. AVX needs the OS to save the wider
+// registers as well as the CPU to support the instructions.
+static int GetSupportedLevel(void)
+{
+#if defined(DSP_ARM64)
+	return SIMD_LEVEL_NEON;
+#elif defined(DSP_X86) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return SIMD_LEVEL_AVX512;
+	if (__builtin_cpu_supports("avx2")) return SIMD_LEVEL_AVX2;
+	if (__builtin_cpu_supports("sse2")) return SIMD_LEVEL_SSE2;
+	return SIMD_LEVEL_SCALAR;
+#elif defined(DSP_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	const int sse2 = (info[3] >> 26) & 1;
+	const int osxsave = (info[2] >> 27) & 1;
+	const int avx = (info[2] >> 28) & 1;
+	if (!sse2) return SIMD_LEVEL_SCALAR;
+	if (!osxsave || !avx || maxLeaf < 7) return SIMD_LEVEL_SSE2;
+
+	const unsigned long long xcr0 = _xgetbv(0);
+	__cpuidex(info, 7, 0);
+	const int avx2 = (info[1] >> 5) & 1;
+	const int avx512 = (info[1] >> 16) & 1;
+
+	if (avx512 && (xcr0 & 0xE6) == 0xE6) return SIMD_LEVEL_AVX512;
+	if (avx2 && (xcr0 & 0x6) == 0x6) return SIMD_LEVEL_AVX2;
+	return SIMD_LEVEL_SSE2;
+#else
+	return SIMD_LEVEL_SCALAR;
+#endif
+}
+
+static int GetRequestedLevel(void)
+{
+	static const struct { const char* Name; int Level; } levels[] =
+	{
+		{ "scalar", SIMD_LEVEL_SCALAR },
+		{ "sse2", SIMD_LEVEL_SSE2 },
+		{ "avx2", SIMD_LEVEL_AVX2 },
+		{ "avx512", SIMD_LEVEL_AVX512 },
+		{ "neon", SIMD_LEVEL_NEON },
+	};
+
+	const char* name = getenv("ATRAC9_SIMD");
+	if (!name) return DSP_LEVEL_AUTO;
+
+	for (int i = 0; i < (int)(sizeof(levels) / sizeof(levels[0])); i++)
+	{
+		if (strcmp(name, levels[i].Name) == 0) return levels[i].Level;
+	}
+
+	return DSP_LEVEL_AUTO;
+}
@@ -0,0 +1,19 @@
+#include "dsp.h"
+
+#ifdef DSP_X86
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#define SIMD_LEVEL SIMD_LEVEL_AVX2
+#define DSP_KERNELS DspKernelsAvx2
+#include "dsp_kernels.h"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
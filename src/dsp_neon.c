@@ -0,0 +1,9 @@
+#include "dsp.h"
+
+#ifdef DSP_ARM64
+
+#define SIMD_LEVEL SIMD_LEVEL_NEON
+#define DSP_KERNELS DspKernelsNeon
+#include "dsp_kernels.h"
+
+#endif
@@ -0,0 +1,3 @@
+#define SIMD_LEVEL SIMD_LEVEL_SCALAR
+#define DSP_KERNELS DspKernelsScalar
+#include "dsp_kernels.h"
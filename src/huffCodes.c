@@ -11,7 +11,7 @@ int ReadHuffmanValue(const HuffmanCodebook* huff, BitReaderCxt* br, int isSigned
 	return isSigned ? SignExtend32(value, huff->ValueBits) : value;
 }
 
-void DecodeHuffmanValues(int* spectrum, int index, int bandCount, const HuffmanCodebook* huff, const int* values)
+void DecodeHuffmanValues(int16_t* spectrum, int index, int bandCount, const HuffmanCodebook* huff, const int* values)
 {
 	const int valueCount = bandCount >> huff->ValueCountPower;
 	const int mask = (1 << huff->ValueBits) - 1;
@@ -1,82 +1,134 @@
 #include "imdct.h"
+#include "dsp.h"
 #include "tables.h"
+#include <string.h>
 
-static void Dct4(Mdct* mdct, double* input, double* output);
+static int IsBatchNarrow(int count);
+static int RunDct4(Mdct* const* mdcts, double* const* inputs, double* output, int count, int binCount);
 
 void RunImdct(Mdct* mdct, double* input, double* output)
 {
-	const int size = 1 << mdct->bits;
+	RunImdctBatch(&mdct, &input, &output, 1, 1 << mdct->bits);
+}
+
+// Runs the IMDCTs of several same-sized channels together, sharing every
+// twiddle factor load between them. Input bins at or above binCount must be
+// zero in every channel.
+void RunImdctBatch(Mdct* const* mdcts, double* const* inputs, double* const* outputs, int count, int binCount)
+{
+	const int bits = mdcts[0]->bits;
+	const int size = 1 << bits;
 	const int half = size / 2;
-	double dctOut[MAX_FRAME_SAMPLES];
-	const double* window = ImdctWindow[mdct->bits - 6];
-	double* previous = mdct->imdctPrevious;
+	const double* window = ImdctWindow[bits - 4];
+	double dctOut[MAX_FRAME_SAMPLES * MAX_CHANNEL_COUNT];
 
-	Dct4(mdct, input, dctOut);
+	if (IsBatchNarrow(count))
+	{
+		for (int ch = 0; ch < count; ch++)
+		{
+			RunImdctBatch(&mdcts[ch], &inputs[ch], &outputs[ch], 1, binCount);
+		}
+		return;
+	}
 
-	for (int i = 0; i < half; i++)
+	const int lanes = RunDct4(mdcts, inputs, dctOut, count, binCount);
+
+	for (int ch = 0; ch < count; ch++)
 	{
-		output[i] = window[i] * dctOut[i + half] + previous[i];
-		output[i + half] = window[i + half] * -dctOut[size - 1 - i] - previous[i + half];
-		previous[i] = window[size - 1 - i] * -dctOut[half - i - 1];
-		previous[i + half] = window[half - i - 1] * dctOut[i];
+		const double* dct = &dctOut[ch];
+		double* output = outputs[ch];
+		double* previous = mdcts[ch]->imdctPrevious;
+		mdcts[ch]->imdctPreviousSilent = 0;
+
+		for (int i = 0; i < half; i++)
+		{
+			output[i] = window[i] * dct[(i + half) * lanes] + previous[i];
+			output[i + half] = window[i + half] * -dct[(size - 1 - i) * lanes] - previous[i + half];
+			previous[i] = window[size - 1 - i] * -dct[(half - i - 1) * lanes];
+			previous[i + half] = window[half - i - 1] * dct[i * lanes];
+		}
 	}
 }
 
-static void Dct4(Mdct* mdct, double* input, double* output)
+// Like RunImdctBatch, but the windowed output is added to float buffers
+// with a stride between samples. Sample i is scaled by gain + gainStep * i.
+void RunImdctBatchAccumulate(Mdct* const* mdcts, double* const* inputs, float* const* outputs, int stride, int count,
+	int binCount, double gain, double gainStep)
 {
-	int MdctBits = mdct->bits;
-	int MdctSize = 1 << MdctBits;
-	const int* shuffleTable = ShuffleTables[MdctBits];
-	const double* sinTable = SinTables[MdctBits];
-	const double* cosTable = CosTables[MdctBits];
-	double dctTemp[MAX_FRAME_SAMPLES];
-
-	int size = MdctSize;
-	int lastIndex = size - 1;
-	int halfSize = size / 2;
-
-	for (int i = 0; i < halfSize; i++)
+	const int bits = mdcts[0]->bits;
+	const int size = 1 << bits;
+	const int half = size / 2;
+	const double* window = ImdctWindow[bits - 4];
+	double dctOut[MAX_FRAME_SAMPLES * MAX_CHANNEL_COUNT];
+
+	if (IsBatchNarrow(count))
 	{
-		int i2 = i * 2;
-		double a = input[i2];
-		double b = input[lastIndex - i2];
-		double sin = sinTable[i];
-		double cos = cosTable[i];
-		dctTemp[i2] = a * cos + b * sin;
-		dctTemp[i2 + 1] = a * sin - b * cos;
+		for (int ch = 0; ch < count; ch++)
+		{
+			RunImdctBatchAccumulate(&mdcts[ch], &inputs[ch], &outputs[ch], stride, 1, binCount, gain, gainStep);
+		}
+		return;
 	}
-	int stageCount = MdctBits - 1;
 
-	for (int stage = 0; stage < stageCount; stage++)
+	const int lanes = RunDct4(mdcts, inputs, dctOut, count, binCount);
+
+	for (int ch = 0; ch < count; ch++)
 	{
-		int blockCount = 1 << stage;
-		int blockSizeBits = stageCount - stage;
-		int blockHalfSizeBits = blockSizeBits - 1;
-		int blockSize = 1 << blockSizeBits;
-		int blockHalfSize = 1 << blockHalfSizeBits;
-		sinTable = SinTables[blockHalfSizeBits];
-		cosTable = CosTables[blockHalfSizeBits];
-
-		for (int block = 0; block < blockCount; block++)
+		const double* dct = &dctOut[ch];
+		float* output = outputs[ch];
+		double* previous = mdcts[ch]->imdctPrevious;
+		mdcts[ch]->imdctPreviousSilent = 0;
+
+		for (int i = 0; i < half; i++)
 		{
-			for (int i = 0; i < blockHalfSize; i++)
-			{
-				int frontPos = (block * blockSize + i) * 2;
-				int backPos = frontPos + blockSize;
-				double a = dctTemp[frontPos] - dctTemp[backPos];
-				double b = dctTemp[frontPos + 1] - dctTemp[backPos + 1];
-				double sin = sinTable[i];
-				double cos = cosTable[i];
-				dctTemp[frontPos] += dctTemp[backPos];
-				dctTemp[frontPos + 1] += dctTemp[backPos + 1];
-				dctTemp[backPos] = a * cos + b * sin;
-				dctTemp[backPos + 1] = a * sin - b * cos;
-			}
+			const double first = window[i] * dct[(i + half) * lanes] + previous[i];
+			const double second = window[i + half] * -dct[(size - 1 - i) * lanes] - previous[i + half];
+			previous[i] = window[size - 1 - i] * -dct[(half - i - 1) * lanes];
+			previous[i + half] = window[half - i - 1] * dct[i * lanes];
+
+			output[i * stride] = (float)(output[i * stride] + (gain + gainStep * i) * first);
+			output[(i + half) * stride] = (float)(output[(i + half) * stride] + (gain + gainStep * (i + half)) * second);
 		}
 	}
+}
+
+// Lanes past the channel count are wasted work, so a batch narrower than a
+// vector is better off vectorized across butterflies instead
+static int IsBatchNarrow(int count)
+{
+	return count > 1 && count < Dsp->Width;
+}
 
-	for (int i = 0; i < MdctSize; i++)
+// Returns the distance between consecutive bins of a channel in output
+static int RunDct4(Mdct* const* mdcts, double* const* inputs, double* output, int count, int binCount)
+{
+	const int width = Dsp->Width;
+	const int lanes = count == 1 ? 1 : (count + width - 1) / width * width;
+	Dsp->Dct4(mdcts[0]->bits, inputs, output, count, lanes, binCount);
+	return lanes;
+}
+
+// The IMDCT of an all-zero spectrum. Only the overlap from the previous
+// frame is left, after which the output stays zero until the next
+// non-silent frame.
+void RunImdctSilent(Mdct* mdct, double* output)
+{
+	const int size = 1 << mdct->bits;
+	const int half = size / 2;
+	double* previous = mdct->imdctPrevious;
+
+	if (mdct->imdctPreviousSilent)
 	{
-		output[i] = dctTemp[shuffleTable[i]];
+		memset(output, 0, size * sizeof(double));
+		return;
 	}
-}
\ No newline at end of file
+
+	for (int i = 0; i < half; i++)
+	{
+		output[i] = previous[i];
+		output[i + half] = -previous[i + half];
+	}
+
+	memset(previous, 0, size * sizeof(double));
+	mdct->imdctPreviousSilent = 1;
+}
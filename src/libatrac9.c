@@ -1,18 +1,41 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include "decinit.h"
 #include "decoder.h"
+#include "dsp.h"
 #include "libatrac9.h"
+#include "loop.h"
+#include "loudness.h"
+#include "meter.h"
+#include "mixer.h"
+#include "overview.h"
+#include "resampler.h"
+#include "riff.h"
+#include "spectral_gain.h"
 #include "structures.h"
+#include "trim.h"
+#include "validate.h"
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
+
+static void* AllocAligned(size_t size);
+static void FreeAligned(void* block);
 
 void* Atrac9GetHandle()
 {
-	return calloc(1, sizeof(Atrac9Handle));
+	return AllocAligned(sizeof(Atrac9Handle));
 }
 
 void Atrac9ReleaseHandle(void* handle)
 {
-	free(handle);
+	if (handle)
+	{
+		FreeAligned(((Atrac9Handle*)handle)->loop);
+		FreeAligned(((Atrac9Handle*)handle)->resampler);
+	}
+	FreeAligned(handle);
 }
 
 int Atrac9InitDecoder(void* handle, unsigned char * pConfigData)
@@ -37,7 +60,244 @@ int Atrac9Decode(void* handle, const void *pAtrac9Buffer, void *pPcmBuffer, Atra
 	return -EINVAL;
 }
 
+int Atrac9DecodeAccumulate(void* handle, const void *pAtrac9Buffer, float *pPcmBuffer, float gainStart, float gainEnd, int *pNBytesUsed)
+{
+	return DecodeAccumulateF32(handle, pAtrac9Buffer, pPcmBuffer, gainStart, gainEnd, pNBytesUsed);
+}
+
 int Atrac9GetCodecInfo(void* handle, Atrac9CodecInfo * pCodecInfo)
 {
 	return GetCodecInfo(handle, (CodecInfo*)pCodecInfo);
 }
+
+int Atrac9Validate(unsigned char *pConfigData, const void *pBuffer, int size, Atrac9ValidationReport *pReport)
+{
+	return Atrac9ValidateRange(pConfigData, pBuffer, size, 0, INT_MAX, pReport);
+}
+
+int Atrac9ValidateRange(unsigned char *pConfigData, const void *pBuffer, int size, int firstSuperframe,
+	int superframeCount, Atrac9ValidationReport *pReport)
+{
+	StreamContext* stream = AllocAligned(sizeof(StreamContext));
+	if (!stream) return -ENOMEM;
+
+	const int status = ValidateSuperframes(stream, pConfigData, pBuffer, size, firstSuperframe, superframeCount,
+		(ValidationReport*)pReport, NULL);
+	FreeAligned(stream);
+	return status;
+}
+
+int Atrac9Analyze(unsigned char *pConfigData, const void *pBuffer, int size, int firstSuperframe,
+	int superframeCount, Atrac9StreamStats *pStats, Atrac9ValidationReport *pReport)
+{
+	StreamContext* stream = AllocAligned(sizeof(StreamContext));
+	if (!stream) return -ENOMEM;
+
+	const int status = ValidateSuperframes(stream, pConfigData, pBuffer, size, firstSuperframe, superframeCount,
+		(ValidationReport*)pReport, (StreamStats*)pStats);
+	FreeAligned(stream);
+	return status;
+}
+
+int Atrac9ScanLoudness(unsigned char *pConfigData, const void *pBuffer, int size, double silenceThreshold,
+	int minSilentFrames, double *pEnvelope, int envelopeSize, Atrac9SilentRegion *pRegions, int regionCapacity,
+	Atrac9LoudnessReport *pReport)
+{
+	StreamContext* stream = AllocAligned(sizeof(StreamContext));
+	if (!stream) return -ENOMEM;
+
+	const int status = ScanLoudness(stream, pConfigData, pBuffer, size, silenceThreshold, minSilentFrames, pEnvelope,
+		envelopeSize, (SilentRegion*)pRegions, regionCapacity, (LoudnessReport*)pReport);
+	FreeAligned(stream);
+	return status;
+}
+
+int Atrac9GetOverview(unsigned char *pConfigData, const void *pBuffer, int size, int bucketSamples,
+	Atrac9OverviewBucket *pBuckets, int bucketCount, Atrac9OverviewReport *pReport)
+{
+	StreamContext* stream = AllocAligned(sizeof(StreamContext));
+	if (!stream) return -ENOMEM;
+
+	const int status = GetOverview(stream, pConfigData, pBuffer, size, bucketSamples, (OverviewBucket*)pBuckets,
+		bucketCount, (OverviewReport*)pReport);
+	FreeAligned(stream);
+	return status;
+}
+
+int Atrac9OpenFile(const char *pPath, void **pFile)
+{
+	RiffFile* file = AllocAligned(sizeof(RiffFile));
+	*pFile = NULL;
+	if (!file) return -ENOMEM;
+
+	const At9Status status = OpenRiffFile(file, pPath);
+	if (status != ERR_SUCCESS)
+	{
+		FreeAligned(file);
+		return status;
+	}
+
+	*pFile = file;
+	return ERR_SUCCESS;
+}
+
+void Atrac9CloseFile(void* file)
+{
+	if (!file) return;
+
+	CloseRiffFile(file);
+	FreeAligned(file);
+}
+
+int Atrac9GetFileInfo(void* file, Atrac9FileInfo *pInfo)
+{
+	memcpy(pInfo, &((RiffFile*)file)->info, sizeof(RiffInfo));
+	return ERR_SUCCESS;
+}
+
+const void* Atrac9GetSuperframe(void* file, int index)
+{
+	return GetRiffSuperframe(file, index);
+}
+
+int Atrac9ParseFile(const void *pBuffer, int size, Atrac9FileInfo *pInfo)
+{
+	if (size < 0) return -EINVAL;
+	return ParseRiff(pBuffer, (size_t)size, (RiffInfo*)pInfo);
+}
+
+int Atrac9SetChannelMap(void* handle, const int *pMap, int count)
+{
+	return SetChannelMap(handle, pMap, count);
+}
+
+int Atrac9SetOutputRate(void* handle, int outputRate)
+{
+	Atrac9Handle* decoder = handle;
+
+	if (!decoder->resampler && outputRate != 0 && outputRate != decoder->config.sampleRate)
+	{
+		decoder->resampler = AllocAligned(sizeof(Resampler));
+		if (!decoder->resampler) return -ENOMEM;
+	}
+
+	return SetOutputRate(decoder, outputRate);
+}
+
+int Atrac9GetOutputSamples(void* handle)
+{
+	return GetOutputSamples(handle);
+}
+
+int Atrac9SetTrim(void* handle, int encoderDelay, int sampleCount)
+{
+	return SetTrim(handle, encoderDelay, sampleCount);
+}
+
+int Atrac9SetLoop(void* handle, int loopStart, int loopEnd)
+{
+	Atrac9Handle* decoder = handle;
+
+	if (!decoder->loop && (loopStart != -1 || loopEnd != -1))
+	{
+		decoder->loop = AllocAligned(sizeof(Loop));
+		if (!decoder->loop) return -ENOMEM;
+	}
+
+	return SetLoop(decoder, loopStart, loopEnd);
+}
+
+int Atrac9GetNextSuperframe(void* handle)
+{
+	return GetNextSuperframe(handle);
+}
+
+int Atrac9SetSpectralGain(void* handle, const float *pGains, int count, int transitionFrames)
+{
+	return SetSpectralGain(handle, pGains, count, transitionFrames);
+}
+
+int Atrac9SetMetering(void* handle, int enable)
+{
+	SetMetering(handle, enable);
+	return ERR_SUCCESS;
+}
+
+int Atrac9GetMeter(void* handle, Atrac9Meter *pMeter)
+{
+	return GetMeter(handle, (MeterInfo*)pMeter);
+}
+
+int Atrac9SetSimdLevel(Atrac9SimdLevel level)
+{
+	return SetDspLevel(level) ? 0 : -EINVAL;
+}
+
+Atrac9SimdLevel Atrac9GetSimdLevel()
+{
+	return (Atrac9SimdLevel)GetDspLevel();
+}
+
+void* Atrac9GetMixer()
+{
+	return AllocAligned(sizeof(Mixer));
+}
+
+void Atrac9ReleaseMixer(void* mixer)
+{
+	FreeAligned(mixer);
+}
+
+int Atrac9InitMixer(void* mixer, int channels, int frameSamples)
+{
+	return InitMixer(mixer, channels, frameSamples);
+}
+
+int Atrac9MixVoice(void* mixer, void* handle, const void *pAtrac9Buffer, double gain, int *pNBytesUsed)
+{
+	return MixVoice(mixer, handle, pAtrac9Buffer, gain, pNBytesUsed);
+}
+
+int Atrac9MixOutput(void* mixer, void *pPcmBuffer, Atrac9Format format)
+{
+	switch (format)
+	{
+	case kAtrac9FormatS16:
+		return MixOutputS16(mixer, pPcmBuffer);
+	case kAtrac9FormatS32:
+		return MixOutputS32(mixer, pPcmBuffer);
+	case kAtrac9FormatF32:
+		return MixOutputF32(mixer, pPcmBuffer);
+	case kAtrac9FormatF64:
+		return MixOutputF64(mixer, pPcmBuffer);
+	}
+
+	return -EINVAL;
+}
+
+// Handles and mixers hold cache-aligned buffers, which calloc doesn't
+// guarantee
+static void* AllocAligned(size_t size)
+{
+	void* block;
+#ifdef _WIN32
+	block = _aligned_malloc(size, CACHE_LINE_SIZE);
+#else
+	if (posix_memalign(&block, CACHE_LINE_SIZE, size) != 0) block = NULL;
+#endif
+
+	if (block)
+	{
+		memset(block, 0, size);
+	}
+	return block;
+}
+
+static void FreeAligned(void* block)
+{
+#ifdef _WIN32
+	_aligned_free(block);
+#else
+	free(block);
+#endif
+}
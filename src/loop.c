@@ -0,0 +1,167 @@
+#include "loop.h"
+#include "bit_reader.h"
+#include "resampler.h"
+#include "unpack.h"
+#include "utility.h"
+#include <string.h>
+
+static void CaptureFrame(Atrac9Handle* handle, long long frameStart);
+static void SaveState(Atrac9Handle* handle);
+static void RestoreState(Atrac9Handle* handle);
+
+// The loop points count from the end of the encoder delay when trimming,
+// like the ones in Atrac9FileInfo, so trimming has to be set first. The end
+// has to be past the loop start's superframe, which is decoded once and
+// kept, so every pass decodes at least one frame. Looping splices the
+// stream's own PCM, so it can't be combined with resampling. Both points -1
+// turn looping off.
+At9Status SetLoop(Atrac9Handle* handle, int loopStart, int loopEnd)
+{
+	Loop* loop = handle->loop;
+	const Trim* trim = &handle->trim;
+	const int superframeSamples = handle->config.superframeSamples;
+
+	if (loopStart == -1 && loopEnd == -1)
+	{
+		if (loop) loop->enabled = FALSE;
+		return ERR_SUCCESS;
+	}
+
+	const long long offset = trim->enabled ? trim->start : 0;
+	const long long start = offset + loopStart;
+	const long long end = offset + loopEnd;
+	const long long resume = (start / superframeSamples + 1) * superframeSamples;
+
+	if (loopStart < 0 || end <= resume || (trim->enabled && end > trim->end) || IsResampling(handle))
+	{
+		return ERR_LOOP_INVALID;
+	}
+
+	loop->enabled = TRUE;
+	loop->captured = FALSE;
+	loop->start = start;
+	loop->end = end;
+	loop->resume = resume;
+	loop->position = 0;
+	loop->skipFrames = 0;
+	loop->outputSamples = 0;
+	return ERR_SUCCESS;
+}
+
+// Takes the samples trimming keeps of the frame just decoded, from first in
+// each channel's PCM, and returns how many the frame outputs. The frame
+// holding the loop end is cut there and followed by the samples kept from
+// the loop start, with buffers pointed at the loop's copy of both.
+int LoopOutput(Atrac9Handle* handle, int first, int count, const double** buffers)
+{
+	Loop* loop = handle->loop;
+	Frame* frame = &handle->frame;
+	const int framesPerSuperframe = handle->config.framesPerSuperframe;
+	const long long frameStart = loop->position;
+	loop->position += handle->config.frameSamples;
+
+	if (!loop->captured) CaptureFrame(handle, frameStart);
+
+	if (!loop->captured || loop->end <= frameStart || loop->end > loop->position)
+	{
+		loop->outputSamples = count;
+		return count;
+	}
+
+	const long long untilEnd = loop->end - frameStart - first;
+	const int kept = (int)(untilEnd < 0 ? 0 : untilEnd > count ? count : untilEnd);
+
+	for (int ch = 0; ch < handle->config.channelCount; ch++)
+	{
+		double* output = &loop->pcm[ch][MAX_FRAME_SAMPLES - kept];
+		memcpy(output, buffers[ch], kept * sizeof(double));
+		buffers[ch] = output;
+	}
+
+	// A silent frame's PCM is zeroed, so the splice is valid either way
+	frame->IsSilent = FALSE;
+	loop->outputSamples = kept + (int)(loop->resume - loop->start);
+
+	loop->skipFrames = frame->IndexInSuperframe == 0 ? 0 : framesPerSuperframe - frame->IndexInSuperframe;
+	if (loop->skipFrames == 0) RestoreState(handle);
+
+	return loop->outputSamples;
+}
+
+// The rest of the superframe that wrapped is only unpacked, to find where
+// each frame ends
+At9Status SkipLoopFrame(Atrac9Handle* handle, const void* audio, int* bytesUsed)
+{
+	Loop* loop = handle->loop;
+	BitReaderCxt br;
+	InitBitReaderCxt(&br, audio);
+	ERROR_CHECK(UnpackFrame(&handle->frame, &br));
+
+	*bytesUsed = br.Position / 8;
+	loop->outputSamples = 0;
+	if (--loop->skipFrames == 0) RestoreState(handle);
+	return ERR_SUCCESS;
+}
+
+// Returns -1 when not looping
+int GetNextSuperframe(const Atrac9Handle* handle)
+{
+	const Loop* loop = handle->loop;
+	if (!loop || !loop->enabled) return -1;
+
+	return (int)(loop->position / handle->config.superframeSamples);
+}
+
+// Keeps the frame's PCM from the loop start on. Every superframe starts
+// from the state the previous one leaves, so the state is saved once the
+// loop start's superframe is done.
+static void CaptureFrame(Atrac9Handle* handle, long long frameStart)
+{
+	Loop* loop = handle->loop;
+	const int frameSamples = handle->config.frameSamples;
+	if (frameStart + frameSamples <= loop->start) return;
+
+	const int first = (int)(loop->start > frameStart ? loop->start - frameStart : 0);
+	const int offset = (int)(frameStart + first - loop->start);
+
+	for (int ch = 0; ch < handle->config.channelCount; ch++)
+	{
+		memcpy(&loop->pcm[ch][MAX_FRAME_SAMPLES + offset], &handle->outputs[ch].pcm[first],
+			(frameSamples - first) * sizeof(double));
+	}
+
+	if (handle->frame.IndexInSuperframe == 0)
+	{
+		SaveState(handle);
+		loop->captured = TRUE;
+	}
+}
+
+static void SaveState(Atrac9Handle* handle)
+{
+	const int blockCount = handle->config.channelConfig.blockCount;
+	memcpy(handle->loop->blocks, handle->frame.Blocks, blockCount * sizeof(Block));
+
+	for (int ch = 0; ch < handle->config.channelCount; ch++)
+	{
+		handle->loop->mdct[ch] = handle->outputs[ch].mdct;
+	}
+}
+
+// Picks up at the superframe after the loop start. Trimming is at the
+// stream's rate here, so its position moves back with the loop's.
+static void RestoreState(Atrac9Handle* handle)
+{
+	Loop* loop = handle->loop;
+	const int blockCount = handle->config.channelConfig.blockCount;
+	memcpy(handle->frame.Blocks, loop->blocks, blockCount * sizeof(Block));
+
+	for (int ch = 0; ch < handle->config.channelCount; ch++)
+	{
+		handle->outputs[ch].mdct = loop->mdct[ch];
+	}
+
+	handle->frame.IndexInSuperframe = 0;
+	loop->position = loop->resume;
+	handle->trim.position = loop->resume;
+}
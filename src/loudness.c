@@ -0,0 +1,331 @@
+#include "loudness.h"
+#include "decinit.h"
+#include "decoder.h"
+#include "tables.h"
+#include "utility.h"
+#include "validate.h"
+#include <math.h>
+#include <string.h>
+
+// Gating blocks are 400 ms long and start every 100 ms, so each one is
+// made of the last 4 segments
+#define GATING_SEGMENTS 4
+#define ABSOLUTE_GATE -70.0
+#define RELATIVE_GATE -10.0
+
+// Block loudness is binned in 0.1 LU steps from the absolute gate, so the
+// relative gate can be applied without keeping every block
+#define LOUDNESS_BINS_PER_LU 10
+#define LOUDNESS_BINS (80 * LOUDNESS_BINS_PER_LU)
+
+typedef struct {
+	double binWeights[MAX_FRAME_SAMPLES];
+	double channelWeights[MAX_CHANNEL_COUNT];
+
+	double segments[GATING_SEGMENTS];
+	int segmentCount;
+	int segmentLength;
+	int segmentSamples;
+	double segmentEnergy;
+	double totalEnergy;
+	long long totalSamples;
+
+	double binPower[LOUDNESS_BINS];
+	int binBlocks[LOUDNESS_BINS];
+
+	double silenceThreshold;
+	int minSilentFrames;
+	int silentFrames;
+	double* envelope;
+	int envelopeSize;
+	SilentRegion* regions;
+	int regionCapacity;
+} LoudnessScan;
+
+static void InitScan(LoudnessScan* scan, const Frame* frame);
+static double KWeighting(double frequency);
+static double BiquadPower(const double* b, const double* a, double omega);
+static At9Status ScanSuperframe(StreamContext* stream, const unsigned char* superframe, LoudnessScan* scan,
+	LoudnessReport* report);
+static double GetFramePower(const Frame* frame, const LoudnessScan* scan);
+static void AddFrame(LoudnessScan* scan, LoudnessReport* report, double power, int frameSamples);
+static void AddBlock(LoudnessScan* scan, double power);
+static void EndSilentRegion(LoudnessScan* scan, LoudnessReport* report);
+static double GetIntegratedLoudness(const LoudnessScan* scan);
+static double PowerToLoudness(double power);
+
+// The spectra are decoded without the IMDCT, and each frame's energy is
+// taken from them by Parseval's theorem. The IMDCT window isn't power
+// complementary, so this is exact on average rather than for every frame,
+// which is plenty for an envelope.
+At9Status ScanLoudness(StreamContext* stream, unsigned char* configData, const unsigned char* buffer, int size,
+	double silenceThreshold, int minSilentFrames, double* envelope, int envelopeSize, SilentRegion* regions,
+	int regionCapacity, LoudnessReport* report)
+{
+	unsigned char padded[PADDED_SUPERFRAME_BYTES];
+	LoudnessScan scan;
+
+	memset(report, 0, sizeof(LoudnessReport));
+	report->integratedLoudness = -HUGE_VAL;
+	report->failedSuperframe = -1;
+
+	report->error = InitStream(stream, configData);
+	if (report->error != ERR_SUCCESS) return report->error;
+
+	const int superframeBytes = stream->config.superframeBytes;
+	report->frameSamples = stream->config.frameSamples;
+	report->samplingRate = stream->config.sampleRate;
+
+	if (size < 0 || envelopeSize < 0 || regionCapacity < 0 || (envelopeSize > 0 && !envelope) ||
+		(regionCapacity > 0 && !regions))
+	{
+		report->error = ERR_VALIDATE_RANGE_INVALID;
+		return report->error;
+	}
+
+	InitScan(&scan, &stream->frame);
+	scan.silenceThreshold = silenceThreshold;
+	scan.minSilentFrames = Max(minSilentFrames, 1);
+	scan.envelope = envelope;
+	scan.envelopeSize = envelopeSize;
+	scan.regions = regions;
+	scan.regionCapacity = regionCapacity;
+
+	const int total = (size + superframeBytes - 1) / superframeBytes;
+
+	for (int i = 0; i < total && report->error == ERR_SUCCESS; i++)
+	{
+		const unsigned char* superframe = GetReadableSuperframe(buffer, size, i, superframeBytes, padded);
+		report->error = superframe ? ScanSuperframe(stream, superframe, &scan, report) :
+			ERR_VALIDATE_SUPERFRAME_TRUNCATED;
+		if (report->error != ERR_SUCCESS) report->failedSuperframe = i;
+	}
+
+	// Everything up to a failure is still reported
+	EndSilentRegion(&scan, report);
+
+	// Streams shorter than a gating block are measured as a single block
+	if (scan.segmentCount < GATING_SEGMENTS && scan.totalSamples > 0)
+	{
+		AddBlock(&scan, scan.totalEnergy / scan.totalSamples);
+	}
+
+	report->integratedLoudness = GetIntegratedLoudness(&scan);
+	return report->error;
+}
+
+// A bin's weight turns its squared coefficient into its share of the
+// frame's mean square, K-weighted and relative to 16-bit full scale
+static void InitScan(LoudnessScan* scan, const Frame* frame)
+{
+	const ConfigData* config = frame->Config;
+	const int frameSamples = config->frameSamples;
+	const double* window = ImdctWindow[config->frameSamplesPower - 4];
+	double windowEnergy = 0;
+
+	memset(scan, 0, sizeof(LoudnessScan));
+	scan->segmentLength = config->sampleRate / 10;
+
+	for (int i = 0; i < frameSamples; i++)
+	{
+		windowEnergy += window[i] * window[i];
+	}
+
+	const double scale = windowEnergy / frameSamples / (32768.0 * 32768.0);
+
+	for (int i = 0; i < frameSamples; i++)
+	{
+		const double frequency = (i + 0.5) * config->sampleRate / (2 * frameSamples);
+		scan->binWeights[i] = KWeighting(frequency) * scale;
+	}
+
+	// LFE channels aren't measured, and surround channels count for 1.5 dB
+	// more than the front ones
+	int channel = 0;
+
+	for (int i = 0; i < config->channelConfig.blockCount; i++)
+	{
+		const Block* block = &frame->Blocks[i];
+		const double weight = block->blockType == LFE ? 0.0 : block->blockType == Stereo && i > 0 ? 1.41 : 1.0;
+
+		for (int c = 0; c < block->channelCount; c++)
+		{
+			scan->channelWeights[channel++] = weight;
+		}
+	}
+}
+
+// The power response of the BS.1770 K-weighting filter. Its coefficients
+// are given for 48 kHz, above whose Nyquist frequency the response is flat
+// anyway.
+static double KWeighting(double frequency)
+{
+	static const double shelfB[3] = { 1.53512485958697, -2.69169618940638, 1.19839281085285 };
+	static const double shelfA[2] = { -1.69065929318241, 0.73248077421585 };
+	static const double highPassB[3] = { 1.0, -2.0, 1.0 };
+	static const double highPassA[2] = { -1.99004745483398, 0.99007225036621 };
+
+	const double omega = 2 * M_PI * fmin(frequency, 24000.0) / 48000.0;
+	return BiquadPower(shelfB, shelfA, omega) * BiquadPower(highPassB, highPassA, omega);
+}
+
+static double BiquadPower(const double* b, const double* a, double omega)
+{
+	const double c1 = cos(omega);
+	const double s1 = sin(omega);
+	const double c2 = cos(2 * omega);
+	const double s2 = sin(2 * omega);
+
+	const double numRe = b[0] + b[1] * c1 + b[2] * c2;
+	const double numIm = -b[1] * s1 - b[2] * s2;
+	const double denRe = 1 + a[0] * c1 + a[1] * c2;
+	const double denIm = -a[0] * s1 - a[1] * s2;
+
+	return (numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm);
+}
+
+static At9Status ScanSuperframe(StreamContext* stream, const unsigned char* superframe, LoudnessScan* scan,
+	LoudnessReport* report)
+{
+	const int frameSamples = stream->config.frameSamples;
+	int position = 0;
+
+	for (int i = 0; i < stream->config.framesPerSuperframe; i++)
+	{
+		int isSilent;
+		int bytesUsed;
+		ERROR_CHECK(DecodeSpectra(&stream->frame, &superframe[position], TRUE, &isSilent, &bytesUsed));
+
+		position += bytesUsed;
+		if (position > stream->config.superframeBytes) return ERR_VALIDATE_SUPERFRAME_OVERRUN;
+
+		AddFrame(scan, report, isSilent ? 0 : GetFramePower(&stream->frame, scan), frameSamples);
+	}
+
+	return ERR_SUCCESS;
+}
+
+// Bins past a channel's spectra count are zero
+static double GetFramePower(const Frame* frame, const LoudnessScan* scan)
+{
+	double power = 0;
+
+	for (int ch = 0; ch < frame->Config->channelCount; ch++)
+	{
+		const Channel* channel = frame->Channels[ch];
+		double sum = 0;
+		if (scan->channelWeights[ch] == 0) continue;
+
+		for (int i = 0; i < channel->spectraCount; i++)
+		{
+			sum += scan->binWeights[i] * channel->spectra[i] * channel->spectra[i];
+		}
+
+		power += scan->channelWeights[ch] * sum;
+	}
+
+	return power;
+}
+
+static void AddFrame(LoudnessScan* scan, LoudnessReport* report, double power, int frameSamples)
+{
+	if (report->frames < scan->envelopeSize)
+	{
+		scan->envelope[report->frames] = power;
+	}
+
+	if (PowerToLoudness(power) < scan->silenceThreshold)
+	{
+		scan->silentFrames++;
+	}
+	else
+	{
+		EndSilentRegion(scan, report);
+	}
+
+	report->frames++;
+
+	scan->totalEnergy += power * frameSamples;
+	scan->totalSamples += frameSamples;
+	scan->segmentEnergy += power * frameSamples;
+	scan->segmentSamples += frameSamples;
+	if (scan->segmentSamples < scan->segmentLength) return;
+
+	memmove(scan->segments, &scan->segments[1], (GATING_SEGMENTS - 1) * sizeof(double));
+	scan->segments[GATING_SEGMENTS - 1] = scan->segmentEnergy / scan->segmentSamples;
+	scan->segmentEnergy = 0;
+	scan->segmentSamples = 0;
+	scan->segmentCount++;
+
+	if (scan->segmentCount >= GATING_SEGMENTS)
+	{
+		double blockPower = 0;
+		for (int i = 0; i < GATING_SEGMENTS; i++)
+		{
+			blockPower += scan->segments[i];
+		}
+		AddBlock(scan, blockPower / GATING_SEGMENTS);
+	}
+}
+
+// Blocks louder than the top bin go in it
+static void AddBlock(LoudnessScan* scan, double power)
+{
+	const double loudness = PowerToLoudness(power);
+	if (loudness <= ABSOLUTE_GATE) return;
+
+	const int bin = Min((int)((loudness - ABSOLUTE_GATE) * LOUDNESS_BINS_PER_LU), LOUDNESS_BINS - 1);
+	scan->binPower[bin] += power;
+	scan->binBlocks[bin]++;
+}
+
+// Regions past the capacity are only counted
+static void EndSilentRegion(LoudnessScan* scan, LoudnessReport* report)
+{
+	if (scan->silentFrames >= scan->minSilentFrames)
+	{
+		if (report->silentRegionCount < scan->regionCapacity)
+		{
+			SilentRegion* region = &scan->regions[report->silentRegionCount];
+			region->firstFrame = report->frames - scan->silentFrames;
+			region->frameCount = scan->silentFrames;
+		}
+		report->silentRegionCount++;
+	}
+
+	scan->silentFrames = 0;
+}
+
+// Blocks are gated at 0.1 LU resolution, keeping a bin when its lower edge
+// is above the relative gate
+static double GetIntegratedLoudness(const LoudnessScan* scan)
+{
+	double power = 0;
+	int blocks = 0;
+
+	for (int i = 0; i < LOUDNESS_BINS; i++)
+	{
+		power += scan->binPower[i];
+		blocks += scan->binBlocks[i];
+	}
+
+	if (blocks == 0) return -HUGE_VAL;
+
+	const double gate = PowerToLoudness(power / blocks) + RELATIVE_GATE;
+	const int firstBin = Max((int)ceil((gate - ABSOLUTE_GATE) * LOUDNESS_BINS_PER_LU), 0);
+	power = 0;
+	blocks = 0;
+
+	for (int i = firstBin; i < LOUDNESS_BINS; i++)
+	{
+		power += scan->binPower[i];
+		blocks += scan->binBlocks[i];
+	}
+
+	return blocks == 0 ? -HUGE_VAL : PowerToLoudness(power / blocks);
+}
+
+static double PowerToLoudness(double power)
+{
+	return power > 0 ? -0.691 + 10 * log10(power) : -HUGE_VAL;
+}
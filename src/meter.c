@@ -0,0 +1,37 @@
+#include "meter.h"
+#include "resampler.h"
+#include "utility.h"
+#include <string.h>
+
+void SetMetering(Atrac9Handle* handle, int enabled)
+{
+	PcmMeter* meter = &handle->frame.Meter;
+	memset(meter, 0, sizeof(PcmMeter));
+	meter->Enabled = enabled ? TRUE : FALSE;
+}
+
+At9Status GetMeter(Atrac9Handle* handle, MeterInfo* info)
+{
+	const PcmMeter* meter = &handle->frame.Meter;
+	if (!meter->Enabled) return ERR_METERING_DISABLED;
+
+	info->channels = handle->frame.OutputChannelCount;
+	info->samples = GetOutputSamples(handle);
+	memcpy(info->peak, meter->Peak, sizeof(info->peak));
+	memcpy(info->sumSquares, meter->SumSquares, sizeof(info->sumSquares));
+	memcpy(info->clips, meter->Clips, sizeof(info->clips));
+	return ERR_SUCCESS;
+}
+
+// Clears the levels before a frame is converted. Returns NULL when
+// metering is off, which the conversion kernels take as not measuring.
+PcmMeter* StartMeter(Frame* frame)
+{
+	PcmMeter* meter = &frame->Meter;
+	if (!meter->Enabled) return NULL;
+
+	memset(meter->Peak, 0, sizeof(meter->Peak));
+	memset(meter->SumSquares, 0, sizeof(meter->SumSquares));
+	memset(meter->Clips, 0, sizeof(meter->Clips));
+	return meter;
+}
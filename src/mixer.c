@@ -0,0 +1,179 @@
+#include "mixer.h"
+#include "decinit.h"
+#include "decoder.h"
+#include "dsp.h"
+#include "imdct.h"
+#include "resampler.h"
+#include "utility.h"
+#include <string.h>
+
+static void ImdctBus(Mixer* mixer, const double** pcm);
+
+At9Status InitMixer(Mixer* mixer, int channelCount, int frameSamples)
+{
+	int bits = 6;
+	while (bits < 8 && (1 << bits) != frameSamples)
+	{
+		bits++;
+	}
+
+	if (channelCount < 1 || channelCount > MAX_CHANNEL_COUNT || (1 << bits) != frameSamples)
+	{
+		return ERR_MIXER_LAYOUT_INVALID;
+	}
+
+	memset(mixer, 0, sizeof(Mixer));
+	mixer->channelCount = channelCount;
+	mixer->frameSamples = frameSamples;
+
+	for (int i = 0; i < channelCount; i++)
+	{
+		mixer->mdct[i].bits = bits;
+		mixer->mdct[i].imdctPreviousSilent = TRUE;
+	}
+
+	InitTables();
+	return ERR_SUCCESS;
+}
+
+// Decodes a frame of a voice and adds its spectra to the bus. A voice has
+// either the bus's channel count or a single channel, which is added to
+// every bus channel. Rates with the same frame size would be summed bin for
+// bin at the wrong pitch, so the bus takes the rate of its first voice. The
+// voice's own overlap isn't used, so a handle shouldn't switch between a
+// mixer and Atrac9Decode mid-stream.
+At9Status MixVoice(Mixer* mixer, Atrac9Handle* handle, const void* audio, double gain, int* bytesUsed)
+{
+	const int voiceChannels = handle->config.channelCount;
+	int isSilent;
+
+	if (handle->config.frameSamples != mixer->frameSamples ||
+		(voiceChannels != 1 && voiceChannels != mixer->channelCount) ||
+		(mixer->sampleRate != 0 && handle->config.sampleRate != mixer->sampleRate))
+	{
+		return ERR_MIXER_VOICE_MISMATCH;
+	}
+
+	// Voices are summed at their own rate
+	if (IsResampling(handle)) return ERR_RESAMPLER_UNSUPPORTED;
+
+	mixer->sampleRate = handle->config.sampleRate;
+
+	ERROR_CHECK(DecodeSpectra(&handle->frame, audio, TRUE, &isSilent, bytesUsed));
+	if (isSilent || gain == 0) return ERR_SUCCESS;
+
+	for (int ch = 0; ch < mixer->channelCount; ch++)
+	{
+		const Channel* channel = handle->frame.Channels[voiceChannels == 1 ? 0 : ch];
+		const int count = channel->spectraCount;
+
+		Dsp->AccumulateSpectra(channel->spectra, mixer->spectra[ch], count, gain);
+		mixer->spectraCount[ch] = Max(mixer->spectraCount[ch], count);
+	}
+
+	return ERR_SUCCESS;
+}
+
+At9Status MixOutputS16(Mixer* mixer, void* pcm)
+{
+	const double* buffers[MAX_CHANNEL_COUNT];
+	ImdctBus(mixer, buffers);
+
+	if (mixer->IsSilent)
+	{
+		memset(pcm, 0, mixer->channelCount * mixer->frameSamples * sizeof(int16_t));
+		return ERR_SUCCESS;
+	}
+
+	Dsp->PcmToS16(buffers, mixer->channelCount, mixer->frameSamples, (int16_t*)pcm, NULL);
+	return ERR_SUCCESS;
+}
+
+At9Status MixOutputS32(Mixer* mixer, void* pcm)
+{
+	const double* buffers[MAX_CHANNEL_COUNT];
+	ImdctBus(mixer, buffers);
+
+	if (mixer->IsSilent)
+	{
+		memset(pcm, 0, mixer->channelCount * mixer->frameSamples * sizeof(int32_t));
+		return ERR_SUCCESS;
+	}
+
+	Dsp->PcmToS32(buffers, mixer->channelCount, mixer->frameSamples, (int32_t*)pcm, NULL);
+	return ERR_SUCCESS;
+}
+
+At9Status MixOutputF32(Mixer* mixer, void* pcm)
+{
+	const double* buffers[MAX_CHANNEL_COUNT];
+	ImdctBus(mixer, buffers);
+
+	if (mixer->IsSilent)
+	{
+		memset(pcm, 0, mixer->channelCount * mixer->frameSamples * sizeof(float));
+		return ERR_SUCCESS;
+	}
+
+	Dsp->PcmToF32(buffers, mixer->channelCount, mixer->frameSamples, (float*)pcm, NULL);
+	return ERR_SUCCESS;
+}
+
+At9Status MixOutputF64(Mixer* mixer, void* pcm)
+{
+	const double* buffers[MAX_CHANNEL_COUNT];
+	ImdctBus(mixer, buffers);
+
+	if (mixer->IsSilent)
+	{
+		memset(pcm, 0, mixer->channelCount * mixer->frameSamples * sizeof(double));
+		return ERR_SUCCESS;
+	}
+
+	Dsp->PcmToF64(buffers, mixer->channelCount, mixer->frameSamples, (double*)pcm, NULL);
+	return ERR_SUCCESS;
+}
+
+// Transforms the mixed frame in a single batch and clears the bus for the
+// next one. Channels no voice contributed to only play out their overlap.
+static void ImdctBus(Mixer* mixer, const double** pcm)
+{
+	Mdct* mdcts[MAX_CHANNEL_COUNT];
+	double* spectra[MAX_CHANNEL_COUNT];
+	double* outputs[MAX_CHANNEL_COUNT];
+	int count = 0;
+	int binCount = 0;
+	int isSilent = TRUE;
+
+	for (int ch = 0; ch < mixer->channelCount; ch++)
+	{
+		pcm[ch] = mixer->pcm[ch];
+
+		if (mixer->spectraCount[ch] == 0)
+		{
+			isSilent &= mixer->mdct[ch].imdctPreviousSilent;
+			RunImdctSilent(&mixer->mdct[ch], mixer->pcm[ch]);
+			continue;
+		}
+
+		mdcts[count] = &mixer->mdct[ch];
+		spectra[count] = mixer->spectra[ch];
+		outputs[count] = mixer->pcm[ch];
+		binCount = Max(binCount, mixer->spectraCount[ch]);
+		isSilent = FALSE;
+		count++;
+	}
+
+	if (count > 0)
+	{
+		RunImdctBatch(mdcts, spectra, outputs, count, binCount);
+	}
+
+	for (int ch = 0; ch < mixer->channelCount; ch++)
+	{
+		memset(mixer->spectra[ch], 0, mixer->spectraCount[ch] * sizeof(double));
+		mixer->spectraCount[ch] = 0;
+	}
+
+	mixer->IsSilent = isSilent;
+}
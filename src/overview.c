@@ -0,0 +1,201 @@
+#include "overview.h"
+#include "decinit.h"
+#include "decoder.h"
+#include "imdct.h"
+#include "utility.h"
+#include "validate.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// The overview is decoded from the lowest quarter of each frame's bins, so
+// every sample it measures stands for this many samples of the stream
+#define OVERVIEW_DECIMATION 4
+
+typedef struct {
+	Mdct mdct[MAX_CHANNEL_COUNT];
+	CACHE_ALIGNED double pcm[MAX_CHANNEL_COUNT][MAX_FRAME_SAMPLES / OVERVIEW_DECIMATION];
+	int channelCount;
+
+	double min[MAX_CHANNEL_COUNT];
+	double max[MAX_CHANNEL_COUNT];
+	double sumSquares[MAX_CHANNEL_COUNT];
+	int count;
+	int bucketSamples;
+	int samplesLeft;
+	OverviewBucket* buckets;
+	int bucketCapacity;
+} OverviewScan;
+
+static void InitScan(OverviewScan* scan, int channelCount, int bits);
+static At9Status ScanSuperframe(StreamContext* stream, const unsigned char* superframe, OverviewScan* scan,
+	OverviewReport* report);
+static void ImdctLowBand(Frame* frame, OverviewScan* scan, int isSilent);
+static void AddSamples(OverviewScan* scan, OverviewReport* report, int sampleCount);
+static void ResetBucket(OverviewScan* scan);
+static void EndBucket(OverviewScan* scan, OverviewReport* report);
+
+// Each frame is decoded without band extension, and only its lowest
+// quarter of bins goes through an IMDCT of a quarter of the size. That
+// gives the stream low-passed and at a quarter of the rate, which is all a
+// waveform thumbnail can show. Decoding stops once the buckets are full.
+At9Status GetOverview(StreamContext* stream, unsigned char* configData, const unsigned char* buffer, int size,
+	int bucketSamples, OverviewBucket* buckets, int bucketCapacity, OverviewReport* report)
+{
+	unsigned char padded[PADDED_SUPERFRAME_BYTES];
+	OverviewScan scan;
+
+	memset(report, 0, sizeof(OverviewReport));
+	report->failedSuperframe = -1;
+
+	report->error = InitStream(stream, configData);
+	if (report->error != ERR_SUCCESS) return report->error;
+
+	const int superframeBytes = stream->config.superframeBytes;
+	report->channels = stream->config.channelCount;
+
+	if (size < 0 || bucketSamples < OVERVIEW_DECIMATION || bucketCapacity < 0 || (bucketCapacity > 0 && !buckets))
+	{
+		report->error = ERR_VALIDATE_RANGE_INVALID;
+		return report->error;
+	}
+
+	InitScan(&scan, stream->config.channelCount, stream->config.frameSamplesPower - 2);
+	scan.bucketSamples = bucketSamples;
+	scan.samplesLeft = bucketSamples;
+	scan.buckets = buckets;
+	scan.bucketCapacity = bucketCapacity;
+
+	const int total = (size + superframeBytes - 1) / superframeBytes;
+
+	for (int i = 0; i < total && report->buckets < bucketCapacity; i++)
+	{
+		const unsigned char* superframe = GetReadableSuperframe(buffer, size, i, superframeBytes, padded);
+		report->error = superframe ? ScanSuperframe(stream, superframe, &scan, report) :
+			ERR_VALIDATE_SUPERFRAME_TRUNCATED;
+
+		if (report->error != ERR_SUCCESS)
+		{
+			report->failedSuperframe = i;
+			break;
+		}
+	}
+
+	// The last bucket is usually short, and still written after a failure
+	if (scan.count > 0 && report->buckets < bucketCapacity) EndBucket(&scan, report);
+	return report->error;
+}
+
+static void InitScan(OverviewScan* scan, int channelCount, int bits)
+{
+	memset(scan, 0, sizeof(OverviewScan));
+	scan->channelCount = channelCount;
+
+	for (int i = 0; i < channelCount; i++)
+	{
+		scan->mdct[i].bits = bits;
+		scan->mdct[i].imdctPreviousSilent = TRUE;
+	}
+
+	ResetBucket(scan);
+}
+
+static At9Status ScanSuperframe(StreamContext* stream, const unsigned char* superframe, OverviewScan* scan,
+	OverviewReport* report)
+{
+	const int sampleCount = stream->config.frameSamples / OVERVIEW_DECIMATION;
+	int position = 0;
+
+	for (int i = 0; i < stream->config.framesPerSuperframe && report->buckets < scan->bucketCapacity; i++)
+	{
+		int isSilent;
+		int bytesUsed;
+		ERROR_CHECK(DecodeSpectra(&stream->frame, &superframe[position], FALSE, &isSilent, &bytesUsed));
+
+		position += bytesUsed;
+		if (position > stream->config.superframeBytes) return ERR_VALIDATE_SUPERFRAME_OVERRUN;
+
+		ImdctLowBand(&stream->frame, scan, isSilent);
+		AddSamples(scan, report, sampleCount);
+	}
+
+	return ERR_SUCCESS;
+}
+
+// The bins of a DCT-IV a quarter of the size are the same frequencies
+// relative to its rate, so the lowest bins carry over with no rescaling
+static void ImdctLowBand(Frame* frame, OverviewScan* scan, int isSilent)
+{
+	Mdct* mdcts[MAX_CHANNEL_COUNT];
+	double* spectra[MAX_CHANNEL_COUNT];
+	double* outputs[MAX_CHANNEL_COUNT];
+	const int size = 1 << scan->mdct[0].bits;
+	int binCount = 0;
+
+	for (int ch = 0; ch < scan->channelCount; ch++)
+	{
+		mdcts[ch] = &scan->mdct[ch];
+		spectra[ch] = frame->Channels[ch]->spectra;
+		outputs[ch] = scan->pcm[ch];
+		binCount = Max(binCount, Min(frame->Channels[ch]->spectraCount, size));
+
+		if (isSilent) RunImdctSilent(&scan->mdct[ch], scan->pcm[ch]);
+	}
+
+	if (!isSilent)
+	{
+		RunImdctBatch(mdcts, spectra, outputs, scan->channelCount, binCount);
+	}
+}
+
+static void AddSamples(OverviewScan* scan, OverviewReport* report, int sampleCount)
+{
+	for (int i = 0; i < sampleCount && report->buckets < scan->bucketCapacity; i++)
+	{
+		for (int ch = 0; ch < scan->channelCount; ch++)
+		{
+			const double sample = scan->pcm[ch][i];
+			if (sample < scan->min[ch]) scan->min[ch] = sample;
+			if (sample > scan->max[ch]) scan->max[ch] = sample;
+			scan->sumSquares[ch] += sample * sample;
+		}
+
+		scan->count++;
+		scan->samplesLeft -= OVERVIEW_DECIMATION;
+
+		// Buckets that aren't a multiple of the decimation carry the
+		// remainder over, so they stay in step with the stream
+		if (scan->samplesLeft <= 0)
+		{
+			EndBucket(scan, report);
+			scan->samplesLeft += scan->bucketSamples;
+		}
+	}
+}
+
+static void ResetBucket(OverviewScan* scan)
+{
+	for (int ch = 0; ch < scan->channelCount; ch++)
+	{
+		scan->min[ch] = DBL_MAX;
+		scan->max[ch] = -DBL_MAX;
+		scan->sumSquares[ch] = 0;
+	}
+
+	scan->count = 0;
+}
+
+static void EndBucket(OverviewScan* scan, OverviewReport* report)
+{
+	OverviewBucket* bucket = &scan->buckets[report->buckets * scan->channelCount];
+
+	for (int ch = 0; ch < scan->channelCount; ch++)
+	{
+		bucket[ch].min = (float)scan->min[ch];
+		bucket[ch].max = (float)scan->max[ch];
+		bucket[ch].rms = (float)sqrt(scan->sumSquares[ch] / scan->count);
+	}
+
+	report->buckets++;
+	ResetBucket(scan);
+}
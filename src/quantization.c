@@ -1,57 +1,78 @@
 #include "quantization.h"
+#include "dsp.h"
 #include "tables.h"
+#include "utility.h"
 #include <string.h>
 
-static void DequantizeQuantUnit(Channel* channel, int band);
-static void ScaleSpectrumChannel(Channel* channel);
+#define UNIT_SPECTRUM_SCALE 15
 
+static void DequantizeChannel(Channel* channel);
+static void ApplyIntensityStereo(Block* block);
+static void DequantizeQuantUnit(const Channel* channel, double* spectra, int band, int scaleFactor, double sign);
+
+// Dequantization, intensity stereo and scaling are done in a single pass
+// over each quant unit using step sizes premultiplied by the unit's scale.
 void DequantizeSpectra(Block* block)
 {
 	for (int i = 0; i < block->channelCount; i++)
 	{
-		Channel* channel = &block->channels[i];
-		memset(channel->spectra, 0, sizeof(channel->spectra));
-
-		for (int j = 0; j < channel->codedQuantUnits; j++)
-		{
-			DequantizeQuantUnit(channel, j);
-		}
+		DequantizeChannel(&block->channels[i]);
 	}
+
+	ApplyIntensityStereo(block);
 }
 
-static void DequantizeQuantUnit(Channel* channel, int band)
+static void DequantizeChannel(Channel* channel)
 {
-	const int subBandIndex = QuantUnitToCoeffIndex[band];
-	const int subBandCount = QuantUnitToCoeffCount[band];
-	const double stepSize = QuantizerStepSize[channel->precisions[band]];
-	const double stepSizeFine = QuantizerFineStepSize[channel->precisionsFine[band]];
+	const int count = QuantUnitToCoeffIndex[channel->codedQuantUnits];
+	const int scaledUnits = Min(channel->codedQuantUnits, channel->block->quantizationUnitCount);
+
+	for (int i = 0; i < scaledUnits; i++)
+	{
+		DequantizeQuantUnit(channel, channel->spectra, i, channel->scaleFactors[i], 1.0);
+	}
+
+	// A stale stereo unit count left by a rejected header can exceed the
+	// unit count. Those units were never scaled, which is a scale of 1.
+	for (int i = scaledUnits; i < channel->codedQuantUnits; i++)
+	{
+		DequantizeQuantUnit(channel, channel->spectra, i, UNIT_SPECTRUM_SCALE, 1.0);
+	}
 
-	for (int sb = 0; sb < subBandCount; sb++)
+	if (channel->spectraCount > count)
 	{
-		const double coarse = channel->quantizedSpectra[subBandIndex + sb] * stepSize;
-		const double fine = channel->quantizedSpectraFine[subBandIndex + sb] * stepSizeFine;
-		channel->spectra[subBandIndex + sb] = coarse + fine;
+		memset(&channel->spectra[count], 0, (channel->spectraCount - count) * sizeof(double));
 	}
 }
 
-void ScaleSpectrumBlock(Block* block)
- {
-	 for (int i = 0; i < block->channelCount; i++)
-	 {
-		 ScaleSpectrumChannel(&block->channels[i]);
-	 }
- }
+// The stereo units of the secondary channel are the primary channel's
+// coefficients, scaled by the secondary channel's scale factors.
+static void ApplyIntensityStereo(Block* block)
+{
+	if (block->blockType != Stereo) return;
+
+	const int totalUnits = block->quantizationUnitCount;
+	const int stereoUnits = block->stereoQuantizationUnit;
+	if (stereoUnits >= totalUnits) return;
+
+	const Channel* source = &block->channels[block->primaryChannelIndex == 0 ? 0 : 1];
+	Channel* dest = &block->channels[block->primaryChannelIndex == 0 ? 1 : 0];
 
-static void ScaleSpectrumChannel(Channel* channel)
+	for (int i = stereoUnits; i < totalUnits; i++)
+	{
+		const double sign = block->jointStereoSigns[i] > 0 ? -1.0 : 1.0;
+		DequantizeQuantUnit(source, dest->spectra, i, dest->scaleFactors[i], sign);
+	}
+}
+
+static void DequantizeQuantUnit(const Channel* channel, double* spectra, int band, int scaleFactor, double sign)
 {
-	 const int quantUnitCount = channel->block->quantizationUnitCount;
-	 double* spectra = channel->spectra;
-
-	 for (int i = 0; i < quantUnitCount; i++)
-	 {
-		 for (int sb = QuantUnitToCoeffIndex[i]; sb < QuantUnitToCoeffIndex[i + 1]; sb++)
-		 {
-			 spectra[sb] *= SpectrumScale[channel->scaleFactors[i]];
-		 }
-	 }
- }
\ No newline at end of file
+	const int subBandIndex = QuantUnitToCoeffIndex[band];
+	const int subBandCount = QuantUnitToCoeffCount[band];
+	const int16_t* quantizedFine = channel->precisionsFine[band] == 0 ? NULL : &channel->quantizedSpectraFine[subBandIndex];
+	const double stepSize = sign * QuantizerScaledStepSize[channel->precisions[band]][scaleFactor];
+	const double stepSizeFine = sign * QuantizerScaledFineStepSize[channel->precisionsFine[band]][scaleFactor];
+
+	Dsp->DequantizeUnit(&channel->quantizedSpectra[subBandIndex], quantizedFine, &spectra[subBandIndex], subBandCount,
+		stepSize, stepSizeFine);
+}
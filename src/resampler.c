@@ -0,0 +1,247 @@
+#include "resampler.h"
+#include "decoder.h"
+#include "dsp.h"
+#include "meter.h"
+#include "trim.h"
+#include "utility.h"
+#include <math.h>
+#include <string.h>
+
+// Output samples are converted in chunks of this many per channel, which
+// can't be more than a silent output channel has
+#define RESAMPLER_CHUNK MAX_FRAME_SAMPLES
+
+typedef void (*PcmConverter)(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter);
+
+static void GenerateFilter(Resampler* resampler);
+static void Resample(Atrac9Handle* handle, void* pcmOut, int sampleSize, PcmConverter convert);
+static int GetOutputCount(const Resampler* resampler, int frameSamples);
+static void ConvertS16(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter);
+static void ConvertS32(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter);
+static void ConvertF32(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter);
+static void ConvertF64(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter);
+static int Gcd(int a, int b);
+
+// An output rate of 0 or the stream's own rate turns resampling off. Rates
+// are limited to 4x downsampling and 8x upsampling.
+At9Status SetOutputRate(Atrac9Handle* handle, int outputRate)
+{
+	Resampler* resampler = handle->resampler;
+	const int inputRate = handle->config.sampleRate;
+
+	if (outputRate == 0 || outputRate == inputRate)
+	{
+		if (resampler) resampler->enabled = FALSE;
+		return ERR_SUCCESS;
+	}
+
+	if (outputRate < 0 || inputRate == 0 || inputRate > outputRate * 4 || outputRate > inputRate * 8)
+	{
+		return ERR_RESAMPLER_RATE_INVALID;
+	}
+
+	// Loops are spliced at the stream's rate
+	if (handle->loop && handle->loop->enabled) return ERR_LOOP_INVALID;
+
+	const int divisor = Gcd(inputRate, outputRate);
+	resampler->inputRate = inputRate / divisor;
+	resampler->outputRate = outputRate / divisor;
+	resampler->position = 0;
+	resampler->phase = 0;
+	memset(resampler->history, 0, sizeof(resampler->history));
+	GenerateFilter(resampler);
+
+	resampler->enabled = TRUE;
+	return ERR_SUCCESS;
+}
+
+int GetOutputSamples(Atrac9Handle* handle)
+{
+	if (handle->loop && handle->loop->enabled) return handle->loop->outputSamples;
+	if (handle->trim.enabled) return handle->trim.outputSamples;
+	return IsResampling(handle) ? handle->resampler->outputSamples : handle->config.frameSamples;
+}
+
+int IsResampling(const Atrac9Handle* handle)
+{
+	return handle->resampler && handle->resampler->enabled;
+}
+
+void ResampleToS16(Atrac9Handle* handle, int16_t* pcmOut)
+{
+	Resample(handle, pcmOut, sizeof(*pcmOut), ConvertS16);
+}
+
+void ResampleToS32(Atrac9Handle* handle, int32_t* pcmOut)
+{
+	Resample(handle, pcmOut, sizeof(*pcmOut), ConvertS32);
+}
+
+void ResampleToF32(Atrac9Handle* handle, float* pcmOut)
+{
+	Resample(handle, pcmOut, sizeof(*pcmOut), ConvertF32);
+}
+
+void ResampleToF64(Atrac9Handle* handle, double* pcmOut)
+{
+	Resample(handle, pcmOut, sizeof(*pcmOut), ConvertF64);
+}
+
+// Blackman-windowed sinc filters, with the cutoff below the Nyquist
+// frequency of the lower of the two rates. Each filter is normalized to
+// unity gain at DC. The filter for fraction f interpolates at a point f
+// past the middle of its taps. When downsampling, the filter is stretched
+// along with the cutoff so the transition band narrows with it, keeping
+// the same accuracy relative to the output rate as upsampling.
+static void GenerateFilter(Resampler* resampler)
+{
+	const double ratio = (double)resampler->outputRate / resampler->inputRate;
+	const double cutoff = 0.45 * (ratio < 1.0 ? ratio : 1.0);
+	int taps = RESAMPLER_TAPS;
+
+	if (ratio < 1.0)
+	{
+		taps = (RESAMPLER_TAPS * resampler->inputRate + resampler->outputRate - 1) / resampler->outputRate;
+		taps = Min((taps + RESAMPLER_TAP_STEP - 1) / RESAMPLER_TAP_STEP * RESAMPLER_TAP_STEP, MAX_RESAMPLER_TAPS);
+	}
+
+	const int half = taps / 2;
+	resampler->taps = taps;
+
+	for (int p = 0; p <= RESAMPLER_PHASES; p++)
+	{
+		double* filter = &resampler->filter[p * taps];
+		double sum = 0;
+
+		for (int t = 0; t < taps; t++)
+		{
+			const double x = t - (half - 1) - (double)p / RESAMPLER_PHASES;
+			const double u = x / half;
+			const double window = 0.42 + 0.5 * cos(M_PI * u) + 0.08 * cos(2 * M_PI * u);
+			const double sinc = x == 0 ? 1.0 : sin(2 * M_PI * cutoff * x) / (2 * M_PI * cutoff * x);
+			filter[t] = sinc * window;
+			sum += filter[t];
+		}
+
+		for (int t = 0; t < taps; t++)
+		{
+			filter[t] /= sum;
+		}
+	}
+}
+
+// Each channel's history is followed by the new frame so the filter can
+// run across the frame boundary. Output stops while a filter would still
+// need samples from the next frame.
+static void Resample(Atrac9Handle* handle, void* pcmOut, int sampleSize, PcmConverter convert)
+{
+	Resampler* resampler = handle->resampler;
+	const int channelCount = handle->config.channelCount;
+	const int taps = resampler->taps;
+	const int frameSamples = handle->config.frameSamples;
+	const int total = GetOutputCount(resampler, frameSamples);
+	int first;
+	const int kept = TrimOutput(handle, total, &first);
+	double input[MAX_CHANNEL_COUNT][MAX_RESAMPLER_TAPS + MAX_FRAME_SAMPLES];
+	CACHE_ALIGNED double output[MAX_CHANNEL_COUNT][RESAMPLER_CHUNK];
+	const double* buffers[MAX_CHANNEL_COUNT];
+	const double* outputs[MAX_CHANNEL_COUNT];
+	const int outputChannels = handle->frame.OutputChannelCount;
+	PcmMeter* meter = StartMeter(&handle->frame);
+	unsigned char* pcm = pcmOut;
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		memcpy(input[ch], resampler->history[ch], taps * sizeof(double));
+		memcpy(&input[ch][taps], handle->outputs[ch].pcm, frameSamples * sizeof(double));
+	}
+
+	for (int ch = 0; ch < MAX_CHANNEL_COUNT; ch++)
+	{
+		buffers[ch] = output[ch];
+	}
+
+	MapOutputChannels(&handle->frame, buffers, outputs);
+
+	for (int done = 0; done < total;)
+	{
+		const int count = Min(total - done, RESAMPLER_CHUNK);
+
+		// Only the outputs inside the trimmed range are converted
+		const int start = Max(first - done, 0);
+		const int end = Min(first + kept - done, count);
+
+		if (start < end)
+		{
+			const double* keptOutputs[MAX_CHANNEL_COUNT];
+
+			for (int ch = 0; ch < channelCount; ch++)
+			{
+				Dsp->Resample(resampler->filter, taps, &input[ch][resampler->position], output[ch], count,
+					resampler->phase, resampler->inputRate, resampler->outputRate);
+			}
+
+			for (int ch = 0; ch < outputChannels; ch++)
+			{
+				keptOutputs[ch] = &outputs[ch][start];
+			}
+
+			convert(keptOutputs, outputChannels, end - start,
+				&pcm[(done + start - first) * outputChannels * sampleSize], meter);
+		}
+
+		const int advance = resampler->phase + count * resampler->inputRate;
+		resampler->position += advance / resampler->outputRate;
+		resampler->phase = advance % resampler->outputRate;
+		done += count;
+	}
+
+	resampler->position -= frameSamples;
+	resampler->outputSamples = total;
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		memcpy(resampler->history[ch], &input[ch][frameSamples], taps * sizeof(double));
+	}
+}
+
+// The number of outputs whose filter starts at or before the last full
+// window of input, frameSamples past the start of the history
+static int GetOutputCount(const Resampler* resampler, int frameSamples)
+{
+	const int limit = (frameSamples - resampler->position + 1) * resampler->outputRate - resampler->phase;
+	if (limit <= 0) return 0;
+
+	return (limit + resampler->inputRate - 1) / resampler->inputRate;
+}
+
+static void ConvertS16(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter)
+{
+	Dsp->PcmToS16(pcm, channelCount, sampleCount, output, meter);
+}
+
+static void ConvertS32(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter)
+{
+	Dsp->PcmToS32(pcm, channelCount, sampleCount, output, meter);
+}
+
+static void ConvertF32(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter)
+{
+	Dsp->PcmToF32(pcm, channelCount, sampleCount, output, meter);
+}
+
+static void ConvertF64(const double* const* pcm, int channelCount, int sampleCount, void* output, PcmMeter* meter)
+{
+	Dsp->PcmToF64(pcm, channelCount, sampleCount, output, meter);
+}
+
+static int Gcd(int a, int b)
+{
+	while (b != 0)
+	{
+		const int rest = a % b;
+		a = b;
+		b = rest;
+	}
+	return a;
+}
@@ -0,0 +1,319 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "riff.h"
+#include "decinit.h"
+#include "utility.h"
+#include <limits.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+// The WAVEFORMATEXTENSIBLE fields up to and including the config data
+#define MIN_FORMAT_CHUNK_SIZE 48
+#define MIN_SAMPLER_CHUNK_SIZE 60
+
+// {47E142D2-36BA-4D8D-88FC-61654F8C836C}
+static const unsigned char Atrac9SubFormat[16] =
+{
+	0xD2, 0x42, 0xE1, 0x47, 0xBA, 0x36, 0x8D, 0x4D, 0x88, 0xFC, 0x61, 0x65, 0x4F, 0x8C, 0x83, 0x6C
+};
+
+static At9Status ParseFormat(const unsigned char* chunk, unsigned int size, RiffInfo* info);
+static At9Status ParseFact(const unsigned char* chunk, unsigned int size, RiffInfo* info);
+static void ParseSampler(const unsigned char* chunk, unsigned int size, RiffInfo* info);
+static void CopyTail(RiffFile* file);
+static At9Status MapFile(const char* path, const unsigned char** data, size_t* size);
+static void UnmapFile(const unsigned char* data, size_t size);
+static int ReadU16(const unsigned char* data);
+static unsigned int ReadU32(const unsigned char* data);
+
+// Only the fmt and data chunks are required. A data chunk running past the
+// end of the file is cut short, so a partly written file keeps the
+// superframes that made it.
+At9Status ParseRiff(const unsigned char* buffer, size_t size, RiffInfo* info)
+{
+	int hasFormat = FALSE;
+	int hasFact = FALSE;
+	int hasData = FALSE;
+
+	memset(info, 0, sizeof(RiffInfo));
+	info->loopStart = -1;
+	info->loopEnd = -1;
+
+	if (size > INT_MAX) return ERR_RIFF_FILE_TOO_LARGE;
+	if (size < 12 || memcmp(buffer, "RIFF", 4) != 0 || memcmp(&buffer[8], "WAVE", 4) != 0)
+	{
+		return ERR_RIFF_HEADER_INVALID;
+	}
+
+	const int end = (int)size;
+	int position = 12;
+
+	while (end - position >= 8)
+	{
+		const unsigned char* chunk = &buffer[position + 8];
+		const unsigned int chunkSize = ReadU32(&buffer[position + 4]);
+		const unsigned int available = end - position - 8;
+
+		if (memcmp(&buffer[position], "data", 4) == 0)
+		{
+			info->dataOffset = position + 8;
+			info->dataSize = (int)(chunkSize < available ? chunkSize : available);
+			hasData = TRUE;
+		}
+		else if (chunkSize > available)
+		{
+			return ERR_RIFF_HEADER_INVALID;
+		}
+		else if (memcmp(&buffer[position], "fmt ", 4) == 0)
+		{
+			ERROR_CHECK(ParseFormat(chunk, chunkSize, info));
+			hasFormat = TRUE;
+		}
+		else if (memcmp(&buffer[position], "fact", 4) == 0)
+		{
+			ERROR_CHECK(ParseFact(chunk, chunkSize, info));
+			hasFact = TRUE;
+		}
+		else if (memcmp(&buffer[position], "smpl", 4) == 0)
+		{
+			ParseSampler(chunk, chunkSize, info);
+		}
+
+		// Chunks are padded to an even size
+		if ((unsigned long long)chunkSize + (chunkSize & 1) >= available) break;
+		position += 8 + chunkSize + (chunkSize & 1);
+	}
+
+	if (!hasFormat || !hasData) return ERR_RIFF_CHUNK_MISSING;
+
+	const CodecInfo* codecInfo = &info->codecInfo;
+	info->superframeCount = info->dataSize / codecInfo->superframeSize;
+
+	if (!hasFact)
+	{
+		info->sampleCount = info->superframeCount * codecInfo->framesInSuperframe * codecInfo->frameSamples;
+	}
+
+	// Loop points count from the first decoded sample and include the last
+	// sample of the loop. They're returned past the encoder delay, with the
+	// end exclusive.
+	if (info->loopEnd >= 0)
+	{
+		info->loopStart -= info->encoderDelay;
+		info->loopEnd -= info->encoderDelay - 1;
+
+		if (info->loopStart < 0 || info->loopEnd <= info->loopStart)
+		{
+			info->loopStart = -1;
+			info->loopEnd = -1;
+		}
+	}
+
+	return ERR_SUCCESS;
+}
+
+At9Status OpenRiffFile(RiffFile* file, const char* path)
+{
+	memset(file, 0, sizeof(RiffFile));
+	ERROR_CHECK(MapFile(path, &file->data, &file->size));
+
+	const At9Status status = ParseRiff(file->data, file->size, &file->info);
+	if (status != ERR_SUCCESS)
+	{
+		CloseRiffFile(file);
+		return status;
+	}
+
+	CopyTail(file);
+	return ERR_SUCCESS;
+}
+
+void CloseRiffFile(RiffFile* file)
+{
+	if (file->data)
+	{
+		UnmapFile(file->data, file->size);
+	}
+
+	file->data = NULL;
+	file->size = 0;
+}
+
+const unsigned char* GetRiffSuperframe(const RiffFile* file, int index)
+{
+	const int superframeBytes = file->info.codecInfo.superframeSize;
+
+	if (index < 0 || index >= file->info.superframeCount) return NULL;
+
+	if (index >= file->firstTailSuperframe)
+	{
+		return &file->tail[(index - file->firstTailSuperframe) * superframeBytes];
+	}
+
+	return &file->data[file->info.dataOffset + index * superframeBytes];
+}
+
+static At9Status ParseFormat(const unsigned char* chunk, unsigned int size, RiffInfo* info)
+{
+	unsigned char configData[CONFIG_DATA_SIZE];
+	ConfigData config;
+
+	if (size < MIN_FORMAT_CHUNK_SIZE || ReadU16(chunk) != WAVE_FORMAT_EXTENSIBLE ||
+		memcmp(&chunk[24], Atrac9SubFormat, sizeof(Atrac9SubFormat)) != 0)
+	{
+		return ERR_RIFF_FORMAT_UNSUPPORTED;
+	}
+
+	memcpy(configData, &chunk[44], CONFIG_DATA_SIZE);
+	ERROR_CHECK(InitConfigData(&config, configData));
+
+	if (ReadU16(&chunk[2]) != config.channelCount || ReadU32(&chunk[4]) != (unsigned int)config.sampleRate ||
+		ReadU16(&chunk[12]) != config.superframeBytes)
+	{
+		return ERR_RIFF_CONFIG_MISMATCH;
+	}
+
+	CodecInfo* codecInfo = &info->codecInfo;
+	codecInfo->channels = config.channelCount;
+	codecInfo->channelConfigIndex = config.channelConfigIndex;
+	codecInfo->samplingRate = config.sampleRate;
+	codecInfo->superframeSize = config.superframeBytes;
+	codecInfo->framesInSuperframe = config.framesPerSuperframe;
+	codecInfo->frameSamples = config.frameSamples;
+	codecInfo->wlength = 16;
+	memcpy(codecInfo->configData, config.configData, CONFIG_DATA_SIZE);
+	return ERR_SUCCESS;
+}
+
+// The sample count is followed by the input overlap delay and then the
+// encoder delay, which is what decoding adds in front of the samples. The
+// count excludes the encoder delay.
+static At9Status ParseFact(const unsigned char* chunk, unsigned int size, RiffInfo* info)
+{
+	const unsigned int sampleCount = size >= 4 ? ReadU32(chunk) : 0;
+	const unsigned int encoderDelay = size >= 12 ? ReadU32(&chunk[8]) : 0;
+
+	if (size < 4 || sampleCount > INT_MAX || encoderDelay > INT_MAX) return ERR_RIFF_HEADER_INVALID;
+
+	info->sampleCount = (int)sampleCount;
+	info->encoderDelay = (int)encoderDelay;
+	return ERR_SUCCESS;
+}
+
+// Only the first loop is used, and a malformed one is ignored
+static void ParseSampler(const unsigned char* chunk, unsigned int size, RiffInfo* info)
+{
+	if (size < MIN_SAMPLER_CHUNK_SIZE || ReadU32(&chunk[28]) == 0) return;
+
+	const unsigned int loopStart = ReadU32(&chunk[44]);
+	const unsigned int loopEnd = ReadU32(&chunk[48]);
+	if (loopStart > loopEnd || loopEnd >= INT_MAX) return;
+
+	info->loopStart = (int)loopStart;
+	info->loopEnd = (int)loopEnd;
+}
+
+// Superframes that end less than a frame's overread from the end of the
+// mapping are read from the padded tail instead
+static void CopyTail(RiffFile* file)
+{
+	const RiffInfo* info = &file->info;
+	const int superframeBytes = info->codecInfo.superframeSize;
+	const int safeBytes = Max((int)file->size - info->dataOffset - MAX_FRAME_OVERREAD, 0);
+
+	file->firstTailSuperframe = Min(safeBytes / superframeBytes, info->superframeCount);
+
+	memcpy(file->tail, &file->data[info->dataOffset + file->firstTailSuperframe * superframeBytes],
+		(info->superframeCount - file->firstTailSuperframe) * superframeBytes);
+}
+
+// The mapping stays valid once the file is closed. Empty files can't be
+// mapped, and are rejected as too short to hold a header.
+#ifdef _WIN32
+static At9Status MapFile(const char* path, const unsigned char** data, size_t* size)
+{
+	LARGE_INTEGER fileSize;
+	const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return ERR_RIFF_OPEN_FAILED;
+
+	const At9Status status = !GetFileSizeEx(file, &fileSize) ? ERR_RIFF_OPEN_FAILED :
+		fileSize.QuadPart < 12 ? ERR_RIFF_HEADER_INVALID :
+		fileSize.QuadPart > INT_MAX ? ERR_RIFF_FILE_TOO_LARGE : ERR_SUCCESS;
+
+	if (status != ERR_SUCCESS)
+	{
+		CloseHandle(file);
+		return status;
+	}
+
+	const HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping) return ERR_RIFF_OPEN_FAILED;
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!view) return ERR_RIFF_OPEN_FAILED;
+
+	*data = view;
+	*size = (size_t)fileSize.QuadPart;
+	return ERR_SUCCESS;
+}
+
+static void UnmapFile(const unsigned char* data, size_t size)
+{
+	(void)size;
+	UnmapViewOfFile(data);
+}
+#else
+static At9Status MapFile(const char* path, const unsigned char** data, size_t* size)
+{
+	struct stat fileStatus;
+	const int file = open(path, O_RDONLY);
+	if (file < 0) return ERR_RIFF_OPEN_FAILED;
+
+	const At9Status status = fstat(file, &fileStatus) != 0 ? ERR_RIFF_OPEN_FAILED :
+		fileStatus.st_size < 12 ? ERR_RIFF_HEADER_INVALID :
+		fileStatus.st_size > INT_MAX ? ERR_RIFF_FILE_TOO_LARGE : ERR_SUCCESS;
+
+	if (status != ERR_SUCCESS)
+	{
+		close(file);
+		return status;
+	}
+
+	const void* view = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED) return ERR_RIFF_OPEN_FAILED;
+
+	*data = view;
+	*size = (size_t)fileStatus.st_size;
+	return ERR_SUCCESS;
+}
+
+static void UnmapFile(const unsigned char* data, size_t size)
+{
+	munmap((void*)data, size);
+}
+#endif
+
+static int ReadU16(const unsigned char* data)
+{
+	return data[0] | data[1] << 8;
+}
+
+static unsigned int ReadU32(const unsigned char* data)
+{
+	return data[0] | data[1] << 8 | data[2] << 16 | (unsigned int)data[3] << 24;
+}
@@ -11,7 +11,10 @@ static void ReadVlcDeltaOffsetWithBaseline(Channel* channel, BitReaderCxt* br, c
 
 At9Status ReadScaleFactors(Channel * channel, BitReaderCxt * br)
 {
-	memset(channel->scaleFactors, 0, sizeof(channel->scaleFactors));
+	// The VLC readers write the first scale factor even when no units are
+	// coded, so it is always treated as possibly non-zero.
+	ClearScaleFactors(channel, channel->block->extensionUnit);
+	channel->scaleFactorCount = Max(channel->scaleFactorCount, 1);
 
 	channel->scaleFactorCodingMode = ReadInt(br, 2);
 	if (channel->channelIndex == 0)
@@ -67,6 +70,15 @@ At9Status ReadScaleFactors(Channel * channel, BitReaderCxt * br)
 	return ERR_SUCCESS;
 }
 
+void ClearScaleFactors(Channel* channel, int count)
+{
+	if (channel->scaleFactorCount > count)
+	{
+		memset(&channel->scaleFactors[count], 0, (channel->scaleFactorCount - count) * sizeof(int));
+	}
+	channel->scaleFactorCount = count;
+}
+
 static void ReadClcOffset(Channel* channel, BitReaderCxt* br)
 {
 	const int maxBits = 5;
@@ -0,0 +1,135 @@
+#include "spectral_gain.h"
+#include "dsp.h"
+#include "tables.h"
+#include "utility.h"
+#include <string.h>
+
+static int IsUnity(const double* curve, int count);
+static int GetCurveBinCount(const double* curve, int count);
+
+// gains holds a weight per quantization unit or per bin. A NULL curve
+// fades back to unity, after which no gain is applied at all.
+At9Status SetSpectralGain(Atrac9Handle* handle, const float* gains, int count, int transitionFrames)
+{
+	SpectralGain* gain = &handle->frame.Gain;
+	const int frameSamples = handle->config.frameSamples;
+
+	if ((gains && count != MAX_QUANT_UNITS && count != frameSamples) || transitionFrames < 0)
+	{
+		return ERR_SPECTRAL_GAIN_INVALID;
+	}
+
+	if (!gain->Enabled)
+	{
+		for (int i = 0; i < frameSamples; i++)
+		{
+			gain->Current[i] = 1.0;
+		}
+	}
+
+	for (int i = 0; i < frameSamples; i++)
+	{
+		gain->Target[i] = 1.0;
+	}
+
+	if (gains && count == MAX_QUANT_UNITS)
+	{
+		for (int unit = 0; unit < MAX_QUANT_UNITS; unit++)
+		{
+			const int end = Min(QuantUnitToCoeffIndex[unit + 1], frameSamples);
+
+			for (int i = QuantUnitToCoeffIndex[unit]; i < end; i++)
+			{
+				gain->Target[i] = gains[unit];
+			}
+		}
+	}
+	else if (gains)
+	{
+		for (int i = 0; i < frameSamples; i++)
+		{
+			gain->Target[i] = gains[i];
+		}
+	}
+
+	gain->TargetIsUnity = IsUnity(gain->Target, frameSamples);
+	if (!gain->Enabled && gain->TargetIsUnity) return ERR_SUCCESS;
+
+	gain->Enabled = TRUE;
+	gain->FramesLeft = transitionFrames;
+
+	if (transitionFrames == 0)
+	{
+		memcpy(gain->Current, gain->Target, frameSamples * sizeof(double));
+		gain->Enabled = !gain->TargetIsUnity;
+	}
+
+	gain->BinCount = Max(GetCurveBinCount(gain->Current, frameSamples), GetCurveBinCount(gain->Target, frameSamples));
+	return ERR_SUCCESS;
+}
+
+// Scales the spectra of a decoded frame, which can shorten their active
+// range when the curve ends in zeros
+void ApplySpectralGain(Frame* frame, int channelCount)
+{
+	SpectralGain* gain = &frame->Gain;
+	AdvanceSpectralGain(frame);
+	if (!gain->Enabled) return;
+
+	for (int i = 0; i < channelCount; i++)
+	{
+		Channel* channel = frame->Channels[i];
+		const int count = Min(channel->spectraCount, gain->BinCount);
+
+		Dsp->ScaleSpectraRamp(channel->spectra, gain->Current, count, 1.0);
+
+		if (channel->spectraCount > count)
+		{
+			memset(&channel->spectra[count], 0, (channel->spectraCount - count) * sizeof(double));
+			channel->spectraCount = count;
+		}
+	}
+}
+
+// Moves the curve a frame closer to its target. Silent frames advance it
+// too, so a transition always takes the requested number of frames.
+void AdvanceSpectralGain(Frame* frame)
+{
+	SpectralGain* gain = &frame->Gain;
+	const int frameSamples = frame->Config->frameSamples;
+
+	if (gain->FramesLeft == 0) return;
+
+	if (--gain->FramesLeft == 0)
+	{
+		memcpy(gain->Current, gain->Target, frameSamples * sizeof(double));
+		gain->Enabled = !gain->TargetIsUnity;
+		gain->BinCount = GetCurveBinCount(gain->Target, frameSamples);
+		return;
+	}
+
+	const double fraction = 1.0 / (gain->FramesLeft + 1);
+
+	for (int i = 0; i < frameSamples; i++)
+	{
+		gain->Current[i] += (gain->Target[i] - gain->Current[i]) * fraction;
+	}
+}
+
+static int IsUnity(const double* curve, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (curve[i] != 1.0) return FALSE;
+	}
+	return TRUE;
+}
+
+static int GetCurveBinCount(const double* curve, int count)
+{
+	while (count > 0 && curve[count - 1] == 0)
+	{
+		count--;
+	}
+	return count;
+}
@@ -1,10 +1,16 @@
 #include "tables.h"
 
-double MdctWindow[3][256];
-double ImdctWindow[3][256];
+double MdctWindow[5][256];
+double ImdctWindow[5][256];
 double SinTables[9][256];
 double CosTables[9][256];
-int ShuffleTables[9][256];
+double ImdctPostSin[5][128];
+double ImdctPostCos[5][128];
+int FftOrderTables[5][128];
+double FftTwiddleSin[8][3][32];
+double FftTwiddleCos[8][3][32];
+double QuantizerScaledStepSize[16][32];
+double QuantizerScaledFineStepSize[16][32];
 
 const ChannelConfig ChannelConfigs[6] =
 {
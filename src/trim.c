@@ -0,0 +1,54 @@
+#include "trim.h"
+#include <limits.h>
+
+static long long ToOutputSamples(const Atrac9Handle* handle, long long samples);
+
+// A sample count of -1 keeps everything past the delay, and with no delay
+// turns trimming off. The range starts from the next frame decoded.
+At9Status SetTrim(Atrac9Handle* handle, int encoderDelay, int sampleCount)
+{
+	Trim* trim = &handle->trim;
+
+	if (encoderDelay < 0 || sampleCount < -1) return ERR_TRIM_INVALID;
+
+	trim->enabled = encoderDelay > 0 || sampleCount >= 0;
+	trim->start = encoderDelay;
+	trim->end = sampleCount < 0 ? LLONG_MAX : (long long)encoderDelay + sampleCount;
+	trim->position = 0;
+	trim->outputSamples = 0;
+	return ERR_SUCCESS;
+}
+
+// Takes the total output samples of a frame and returns how many of them
+// are kept, starting at first. The range is mapped to the output rate when
+// resampling, so it can be set before or after the rate.
+int TrimOutput(Atrac9Handle* handle, int total, int* first)
+{
+	Trim* trim = &handle->trim;
+
+	*first = 0;
+	if (!trim->enabled) return total;
+
+	const long long start = ToOutputSamples(handle, trim->start) - trim->position;
+	const long long end = ToOutputSamples(handle, trim->end) - trim->position;
+	trim->position += total;
+
+	const int keepStart = (int)(start < 0 ? 0 : start > total ? total : start);
+	const int keepEnd = (int)(end < keepStart ? keepStart : end > total ? total : end);
+
+	*first = keepStart;
+	trim->outputSamples = keepEnd - keepStart;
+	return trim->outputSamples;
+}
+
+// The first output sample at or past a stream sample. The resampler's output
+// sample n is filtered around input sample n * inputRate / outputRate less
+// half its taps and one.
+static long long ToOutputSamples(const Atrac9Handle* handle, long long samples)
+{
+	const Resampler* resampler = handle->resampler;
+	if (!resampler || !resampler->enabled || samples == LLONG_MAX) return samples;
+
+	const int latency = resampler->taps / 2 + 1;
+	return ((samples + latency) * resampler->outputRate + resampler->inputRate - 1) / resampler->inputRate;
+}
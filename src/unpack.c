@@ -3,10 +3,14 @@
 #include "bit_allocation.h"
 #include "huffCodes.h"
 #include "scale_factors.h"
+#include "simd.h"
 #include "tables.h"
 #include "utility.h"
 #include <string.h>
 
+// MAX_QUANT_UNITS rounded up to a whole number of vectors
+#define UNIT_BUFFER_SIZE 32
+
 static At9Status UnpackBlock(Block* block, BitReaderCxt* br);
 static At9Status ReadBlockHeader(Block* block, BitReaderCxt* br);
 static At9Status UnpackStandardBlock(Block* block, BitReaderCxt* br);
@@ -15,10 +19,12 @@ static At9Status ReadGradientParams(Block* block, BitReaderCxt* br);
 static At9Status ReadStereoParams(Block* block, BitReaderCxt* br);
 static At9Status ReadExtensionParams(Block* block, BitReaderCxt* br);
 static void UpdateCodedUnits(Channel* channel);
-static void CalculateSpectrumCodebookIndex(Channel* channel);
+static void CountBlockParams(const Block* block, StreamStats* stats);
+static void CountChannelParams(const Channel* channel, StreamStats* stats);
 
 static At9Status ReadSpectra(Channel* channel, BitReaderCxt* br);
 static At9Status ReadSpectraFine(Channel* channel, BitReaderCxt* br);
+static void ClearQuantizedSpectra(Channel* channel);
 
 static At9Status UnpackLfeBlock(Block* block, BitReaderCxt* br);
 static void DecodeLfeScaleFactors(Channel* channel, BitReaderCxt* br);
@@ -39,6 +45,7 @@ At9Status UnpackFrame(Frame* frame, BitReaderCxt* br)
 		}
 	}
 
+	if (frame->Stats) frame->Stats->frames++;
 	frame->IndexInSuperframe++;
 
 	if (frame->IndexInSuperframe == frame->Config->framesPerSuperframe)
@@ -49,8 +56,13 @@ At9Status UnpackFrame(Frame* frame, BitReaderCxt* br)
 	return ERR_SUCCESS;
 }
 
+// Everything but the spectra and the alignment is counted as side info
 static At9Status UnpackBlock(Block* block, BitReaderCxt* br)
 {
+	StreamStats* stats = block->frame->Stats;
+	const int start = br->Position;
+	const long long spectraStart = stats ? stats->spectraBits : 0;
+
 	ERROR_CHECK(ReadBlockHeader(block, br));
 
 	if (block->blockType == LFE)
@@ -62,7 +74,14 @@ static At9Status UnpackBlock(Block* block, BitReaderCxt* br)
 		ERROR_CHECK(UnpackStandardBlock(block, br));
 	}
 
+	const int end = br->Position;
 	AlignPosition(br, 8);
+
+	if (stats)
+	{
+		stats->sideInfoBits += end - start - (stats->spectraBits - spectraStart);
+		stats->paddingBits += br->Position - end;
+	}
 	return ERR_SUCCESS;
 }
 
@@ -81,6 +100,8 @@ static At9Status ReadBlockHeader(Block* block, BitReaderCxt* br)
 
 static At9Status UnpackStandardBlock(Block* block, BitReaderCxt* br)
 {
+	StreamStats* stats = block->frame->Stats;
+
 	if (!block->reuseBandParams)
 	{
 		ERROR_CHECK(ReadBandParams(block, br));
@@ -90,6 +111,7 @@ static At9Status UnpackStandardBlock(Block* block, BitReaderCxt* br)
 	ERROR_CHECK(CreateGradient(block));
 	ERROR_CHECK(ReadStereoParams(block, br));
 	ERROR_CHECK(ReadExtensionParams(block, br));
+	if (stats) CountBlockParams(block, stats);
 
 	for (int i = 0; i < block->channelCount; i++)
 	{
@@ -97,12 +119,14 @@ static At9Status UnpackStandardBlock(Block* block, BitReaderCxt* br)
 		UpdateCodedUnits(channel);
 
 		ERROR_CHECK(ReadScaleFactors(channel, br));
-		CalculateMask(channel);
-		CalculatePrecisions(channel);
+		UpdatePrecisions(channel);
 		CalculateSpectrumCodebookIndex(channel);
+		if (stats) CountChannelParams(channel, stats);
 
+		const int spectraStart = br->Position;
 		ERROR_CHECK(ReadSpectra(channel, br));
 		ERROR_CHECK(ReadSpectraFine(channel, br));
+		if (stats) stats->spectraBits += br->Position - spectraStart;
 	}
 
 	block->quantizationUnitsPrev = block->bandExtensionEnabled ? block->extensionUnit : block->quantizationUnitCount;
@@ -232,6 +256,8 @@ static void BexReadHeader(Channel* channel, BitReaderCxt* br, int bexBand)
 	const int bexMode = ReadInt(br, 2);
 	channel->bexMode = bexBand > 2 ? bexMode : 4;
 	channel->bexValueCount = BexEncodedValueCounts[channel->bexMode][bexBand];
+
+	if (channel->frame->Stats) channel->frame->Stats->bexMode[channel->bexMode]++;
 }
 
 static void BexReadData(Channel* channel, BitReaderCxt* br, int bexBand)
@@ -248,6 +274,12 @@ static At9Status ReadExtensionParams(Block* block, BitReaderCxt* br)
 	int bexBand = 0;
 	if (block->bandExtensionEnabled)
 	{
+		// Band extension is only defined for 13 to 20 coded units
+		if (block->quantizationUnitCount < 13 || block->quantizationUnitCount > 20)
+		{
+			return ERR_UNPACK_BAND_PARAMS_INVALID;
+		}
+
 		bexBand = BexGroupInfo[block->quantizationUnitCount - 13].BandCount;
 		if (block->blockType == Stereo)
 		{
@@ -303,19 +335,26 @@ static void UpdateCodedUnits(Channel* channel)
 	}
 }
 
-static void CalculateSpectrumCodebookIndex(Channel* channel)
+// Units from 8 up use the alternate codebooks when their scale factor peaks
+// above its neighbors. The test runs over whole vectors in a local copy of
+// the scale factors padded to the end of the last vector.
+void CalculateSpectrumCodebookIndex(Channel* channel)
 {
-	memset(channel->codebookSet, 0, sizeof(channel->codebookSet));
 	const int quantUnits = channel->codedQuantUnits;
-	int* sf = channel->scaleFactors;
+	memset(channel->codebookSet, 0, quantUnits * sizeof(int));
 
-	if (quantUnits <= 1) return;
+	if (quantUnits <= 8) return;
 	if (channel->config->highSampleRate) return;
 
-	// Temporarily setting this value allows for simpler code by
-	// making the last value a non-special case.
-	const int originalScaleTmp = sf[quantUnits];
-	sf[quantUnits] = sf[quantUnits - 1];
+	// The unit past the end repeats the last value so that the last unit
+	// is not a special case.
+	int sf[UNIT_BUFFER_SIZE + 1];
+	int codebookSet[UNIT_BUFFER_SIZE];
+	memcpy(sf, channel->scaleFactors, quantUnits * sizeof(int));
+	for (int i = quantUnits; i < SimdRoundUpI(quantUnits) + 1; i++)
+	{
+		sf[i] = sf[i - 1];
+	}
 
 	int avg = 0;
 	if (quantUnits > 12)
@@ -327,36 +366,76 @@ static void CalculateSpectrumCodebookIndex(Channel* channel)
 		avg = (avg + 6) / 12;
 	}
 
-	for (int i = 8; i < quantUnits; i++)
+	// Units 20 and up hold 16 coefficients and get a lower threshold
+	const SimdInt lanes = SimdLaneIndexI();
+	const SimdInt two = SimdSet1I(2);
+	const SimdInt one = SimdSet1I(1);
+	const SimdInt lastNarrowUnit = SimdSet1I(11);
+	const SimdInt lastMediumUnit = SimdSet1I(19);
+	const SimdInt avgThreshold = SimdSet1I(avg - 1);
+
+	for (int i = 8; i < quantUnits; i += SIMD_INT_WIDTH)
 	{
-		const int prevSf = sf[i - 1];
-		const int nextSf = sf[i + 1];
-		const int minSf = Min(prevSf, nextSf);
-		if (sf[i] - minSf >= 3 || sf[i] - prevSf + sf[i] - nextSf >= 3)
-		{
-			channel->codebookSet[i] = 1;
-		}
+		const SimdInt index = SimdAddI(SimdSet1I(i), lanes);
+		const SimdInt current = SimdLoadI(&sf[i]);
+		const SimdInt prev = SimdLoadI(&sf[i - 1]);
+		const SimdInt next = SimdLoadI(&sf[i + 1]);
+		const SimdInt aboveMin = SimdSubI(current, SimdMinI(prev, next));
+		const SimdInt aboveBoth = SimdSubI(SimdSubI(SimdAddI(current, current), prev), next);
+		const SimdInt peak = SimdOrI(SimdCmpGtI(aboveMin, two), SimdCmpGtI(aboveBoth, two));
+
+		const SimdInt threshold = SimdAddI(avgThreshold, SimdCmpGtI(index, lastMediumUnit));
+		SimdInt loud = SimdAndI(SimdCmpGtI(aboveMin, one), SimdCmpGtI(current, threshold));
+		loud = SimdAndI(loud, SimdCmpGtI(index, lastNarrowUnit));
+
+		SimdStoreI(&codebookSet[i], SimdAndI(SimdOrI(peak, loud), one));
 	}
 
-	for (int i = 12; i < quantUnits; i++)
+	memcpy(&channel->codebookSet[8], &codebookSet[8], (quantUnits - 8) * sizeof(int));
+}
+
+// Band params are counted for every standard block, including those that
+// reuse the previous frame's
+static void CountBlockParams(const Block* block, StreamStats* stats)
+{
+	stats->blocks++;
+	stats->bandCount[block->bandCount]++;
+	stats->gradientMode[block->gradientMode]++;
+
+	if (block->blockType == Stereo)
+	{
+		stats->stereoBand[block->stereoBand]++;
+	}
+	if (block->bandExtensionEnabled)
 	{
-		if (channel->codebookSet[i] == 0)
+		stats->extensionBand[block->extensionBand]++;
+	}
+}
+
+static void CountChannelParams(const Channel* channel, StreamStats* stats)
+{
+	const int maxHuffPrecision = MaxHuffPrecision[channel->config->highSampleRate];
+	stats->scaleFactorCodingMode[channel->channelIndex][channel->scaleFactorCodingMode]++;
+
+	for (int i = 0; i < channel->codedQuantUnits; i++)
+	{
+		const int precision = channel->precisions[i] + 1;
+
+		if (precision <= maxHuffPrecision)
 		{
-			const int minSf = Min(sf[i - 1], sf[i + 1]);
-			if (sf[i] - minSf >= 2 && sf[i] >= avg - (QuantUnitToCoeffCount[i] == 16 ? 1 : 0))
-			{
-				channel->codebookSet[i] = 1;
-			}
+			stats->huffmanUnits[channel->codebookSet[i]][precision]++;
+		}
+		else
+		{
+			stats->fixedLengthUnits++;
 		}
 	}
-
-	sf[quantUnits] = originalScaleTmp;
 }
 
 static At9Status ReadSpectra(Channel* channel, BitReaderCxt* br)
 {
 	int values[16];
-	memset(channel->quantizedSpectra, 0, sizeof(channel->quantizedSpectra));
+	ClearQuantizedSpectra(channel);
 	const int maxHuffPrecision = MaxHuffPrecision[channel->config->highSampleRate];
 
 	for (int i = 0; i < channel->codedQuantUnits; i++)
@@ -387,10 +466,10 @@ static At9Status ReadSpectra(Channel* channel, BitReaderCxt* br)
 	return ERR_SUCCESS;
 }
 
+// Fine spectra are only written for units that have fine precision, and
+// only read back for those same units.
 static At9Status ReadSpectraFine(Channel* channel, BitReaderCxt* br)
 {
-	memset(channel->quantizedSpectraFine, 0, sizeof(channel->quantizedSpectraFine));
-
 	for (int i = 0; i < channel->codedQuantUnits; i++)
 	{
 		if (channel->precisionsFine[i] > 0)
@@ -408,6 +487,19 @@ static At9Status ReadSpectraFine(Channel* channel, BitReaderCxt* br)
 	return ERR_SUCCESS;
 }
 
+// Every coefficient of the coded units is overwritten by the reader, so
+// only the part of the previous frame's range past them needs clearing.
+static void ClearQuantizedSpectra(Channel* channel)
+{
+	const int count = QuantUnitToCoeffIndex[channel->codedQuantUnits];
+
+	if (channel->quantizedSpectraCount > count)
+	{
+		memset(&channel->quantizedSpectra[count], 0, (channel->quantizedSpectraCount - count) * sizeof(int16_t));
+	}
+	channel->quantizedSpectraCount = count;
+}
+
 static At9Status UnpackLfeBlock(Block* block, BitReaderCxt* br)
 {
 	Channel* channel = &block->channels[0];
@@ -416,14 +508,17 @@ static At9Status UnpackLfeBlock(Block* block, BitReaderCxt* br)
 	DecodeLfeScaleFactors(channel, br);
 	CalculateLfePrecision(channel);
 	channel->codedQuantUnits = block->quantizationUnitCount;
+
+	const int spectraStart = br->Position;
 	ReadLfeSpectra(channel, br);
+	if (block->frame->Stats) block->frame->Stats->spectraBits += br->Position - spectraStart;
 
 	return ERR_SUCCESS;
 }
 
 static void DecodeLfeScaleFactors(Channel* channel, BitReaderCxt* br)
 {
-	memset(channel->scaleFactors, 0, sizeof(channel->scaleFactors));
+	ClearScaleFactors(channel, channel->block->quantizationUnitCount);
 	for (int i = 0; i < channel->block->quantizationUnitCount; i++)
 	{
 		channel->scaleFactors[i] = ReadInt(br, 5);
@@ -443,7 +538,7 @@ static void CalculateLfePrecision(Channel* channel)
 
 static void ReadLfeSpectra(Channel* channel, BitReaderCxt* br)
 {
-	memset(channel->quantizedSpectra, 0, sizeof(channel->quantizedSpectra));
+	ClearQuantizedSpectra(channel);
 
 	for (int i = 0; i < channel->codedQuantUnits; i++)
 	{
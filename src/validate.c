@@ -0,0 +1,113 @@
+#include "validate.h"
+#include "bit_reader.h"
+#include "decinit.h"
+#include "unpack.h"
+#include "utility.h"
+#include <string.h>
+
+static At9Status ValidateSuperframe(StreamContext* stream, const unsigned char* superframe, int* failedFrame);
+
+// Only the frames are unpacked, which is what can fail in a decode. Every
+// superframe is checked from the state its first frame resets, so a range
+// gives the same result as it does as part of the whole stream. Stats, when
+// not NULL, cover every frame read up to the first failure.
+At9Status ValidateSuperframes(StreamContext* stream, unsigned char* configData, const unsigned char* buffer, int size,
+	int first, int count, ValidationReport* report, StreamStats* stats)
+{
+	unsigned char padded[PADDED_SUPERFRAME_BYTES];
+
+	memset(report, 0, sizeof(ValidationReport));
+	report->failedSuperframe = -1;
+	report->failedFrame = -1;
+
+	if (stats) memset(stats, 0, sizeof(StreamStats));
+
+	report->error = InitStream(stream, configData);
+	if (report->error != ERR_SUCCESS) return report->error;
+	stream->frame.Stats = stats;
+
+	const int superframeBytes = stream->config.superframeBytes;
+	const int total = size < 0 ? 0 : (size + superframeBytes - 1) / superframeBytes;
+	report->superframeSize = superframeBytes;
+	report->superframeCount = total;
+
+	if (size < 0 || first < 0 || first > total || count < 0)
+	{
+		report->error = ERR_VALIDATE_RANGE_INVALID;
+		return report->error;
+	}
+
+	const int end = first + Min(count, total - first);
+
+	for (int i = first; i < end; i++)
+	{
+		const unsigned char* superframe = GetReadableSuperframe(buffer, size, i, superframeBytes, padded);
+		int failedFrame = -1;
+		const At9Status status = superframe ? ValidateSuperframe(stream, superframe, &failedFrame) :
+			ERR_VALIDATE_SUPERFRAME_TRUNCATED;
+
+		report->superframesChecked++;
+
+		if (status != ERR_SUCCESS)
+		{
+			report->failedSuperframe = i;
+			report->failedFrame = failedFrame;
+			report->error = status;
+			return status;
+		}
+	}
+
+	return ERR_SUCCESS;
+}
+
+// Superframes near the end of the buffer are read from a copy in padded, so
+// a corrupt one can't read past the buffer. Returns NULL when the superframe
+// is cut short.
+const unsigned char* GetReadableSuperframe(const unsigned char* buffer, int size, int index, int superframeBytes,
+	unsigned char* padded)
+{
+	const unsigned char* superframe = &buffer[index * superframeBytes];
+	const int available = size - index * superframeBytes;
+
+	if (available < superframeBytes) return NULL;
+	if (available - superframeBytes >= MAX_FRAME_OVERREAD) return superframe;
+
+	memcpy(padded, superframe, superframeBytes);
+	memset(&padded[superframeBytes], 0, MAX_FRAME_OVERREAD);
+	return padded;
+}
+
+// The decoder lets a superframe's first frame go without the first frame
+// flag, which carries band params and scale factors over from the previous
+// superframe. Such a superframe can't be checked on its own, so it gets its
+// own error rather than a parse error. The first block's flag is the first
+// bit of the superframe, and is read before unpacking anything that may
+// depend on the previous superframe.
+static At9Status ValidateSuperframe(StreamContext* stream, const unsigned char* superframe, int* failedFrame)
+{
+	Frame* frame = &stream->frame;
+	const int blockCount = stream->config.channelConfig.blockCount;
+	BitReaderCxt br;
+	InitBitReaderCxt(&br, superframe);
+	frame->IndexInSuperframe = 0;
+
+	*failedFrame = 0;
+	if (PeekInt(&br, 1)) return ERR_VALIDATE_SUPERFRAME_DEPENDENT;
+
+	for (int i = 0; i < stream->config.framesPerSuperframe; i++)
+	{
+		*failedFrame = i;
+		ERROR_CHECK(UnpackFrame(frame, &br));
+
+		for (int b = 0; b < blockCount && i == 0; b++)
+		{
+			if (!frame->Blocks[b].firstInSuperframe) return ERR_VALIDATE_SUPERFRAME_DEPENDENT;
+		}
+
+		if (br.Position > stream->config.superframeBytes * 8) return ERR_VALIDATE_SUPERFRAME_OVERRUN;
+	}
+
+	// Whatever follows the last frame is padding too
+	if (frame->Stats) frame->Stats->paddingBits += stream->config.superframeBytes * 8 - br.Position;
+	return ERR_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include "libatrac9/libatrac9.h"
+#include "test_stream.h"
+#include <stdio.h>
+#include <string.h>
+
+// Atrac9DecodeAccumulate at unity gain into silence has to give exactly
+// what Atrac9Decode writes as F32 through the same channel map, whether the
+// map reorders, drops or duplicates the stream's channels.
+
+#define SUPERFRAME_COUNT 24
+#define SUPERFRAME_BYTES 108
+#define FRAME_SAMPLES 64
+
+typedef struct ChannelMap_s {
+	int count;
+	int map[3];
+} ChannelMap;
+
+static const ChannelMap Maps[] =
+{
+	{ 2, { 1, 0 } },
+	{ 3, { 1, -1, 0 } },
+	{ 2, { 0, 0 } },
+	{ 1, { 1 } },
+	{ 3, { -1, 1, 1 } },
+};
+
+static int CheckMap(const ChannelMap* map)
+{
+	void* decoder = Atrac9GetHandle();
+	void* accumulator = Atrac9GetHandle();
+	int failures = 0;
+
+	if (!decoder || !accumulator || Atrac9InitDecoder(decoder, TestStreamConfig) != 0 ||
+		Atrac9InitDecoder(accumulator, TestStreamConfig) != 0 ||
+		Atrac9SetChannelMap(decoder, map->map, map->count) != 0 ||
+		Atrac9SetChannelMap(accumulator, map->map, map->count) != 0)
+	{
+		return 1;
+	}
+
+	for (int i = 0; i < SUPERFRAME_COUNT; i++)
+	{
+		const unsigned char* superframe = &TestStream[i * SUPERFRAME_BYTES];
+		float expected[FRAME_SAMPLES * 3];
+		float mixed[FRAME_SAMPLES * 3];
+		int bytesUsed;
+		memset(mixed, 0, sizeof(mixed));
+
+		if (Atrac9Decode(decoder, superframe, expected, kAtrac9FormatF32, &bytesUsed) != 0 ||
+			Atrac9DecodeAccumulate(accumulator, superframe, mixed, 1.0f, 1.0f, &bytesUsed) != 0 ||
+			memcmp(mixed, expected, FRAME_SAMPLES * map->count * sizeof(float)) != 0)
+		{
+			printf("map of %d channels starting %d, %d: superframe %d differs\n", map->count, map->map[0],
+				map->map[1], i);
+			failures++;
+			break;
+		}
+	}
+
+	Atrac9ReleaseHandle(accumulator);
+	Atrac9ReleaseHandle(decoder);
+	return failures;
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	for (size_t i = 0; i < sizeof(Maps) / sizeof(Maps[0]); i++)
+	{
+		failures += CheckMap(&Maps[i]);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
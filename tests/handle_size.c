@@ -0,0 +1,64 @@
+#include "libatrac9/libatrac9.h"
+#include "structures.h"
+#include "test_stream.h"
+#include <stdio.h>
+
+// The loop state is larger than the rest of the handle, so a handle only
+// gets it once a loop is set. Decoding without a loop must not allocate it.
+
+#define SUPERFRAME_BYTES 108
+#define FRAME_SAMPLES 64
+
+static int Decode(Atrac9Handle* handle, int superframe)
+{
+	short pcm[2 * (FRAME_SAMPLES + MAX_SUPERFRAME_SAMPLES)];
+	int bytesUsed;
+	return Atrac9Decode(handle, &TestStream[superframe * SUPERFRAME_BYTES], pcm, kAtrac9FormatS16, &bytesUsed);
+}
+
+int main(void)
+{
+	int failures = 0;
+
+	if (sizeof(Atrac9Handle) >= sizeof(Loop))
+	{
+		printf("the handle is %d bytes, and the loop state %d\n", (int)sizeof(Atrac9Handle), (int)sizeof(Loop));
+		failures++;
+	}
+
+	Atrac9Handle* handle = Atrac9GetHandle();
+	if (!handle || Atrac9InitDecoder(handle, TestStreamConfig) != 0) return 1;
+
+	for (int i = 0; i < 4; i++)
+	{
+		failures += Decode(handle, i) != 0;
+	}
+
+	if (handle->loop)
+	{
+		printf("decoding without a loop allocated the loop state\n");
+		failures++;
+	}
+
+	// Loops superframes 1 to 3. The superframe holding the loop start is
+	// kept, so the first wrap goes on with superframe 2.
+	Atrac9InitDecoder(handle, TestStreamConfig);
+	failures += Atrac9SetLoop(handle, FRAME_SAMPLES, 4 * FRAME_SAMPLES) != 0;
+
+	for (int i = 0; i < 4 && handle->loop; i++)
+	{
+		failures += Decode(handle, Atrac9GetNextSuperframe(handle)) != 0;
+	}
+
+	if (!handle->loop || Atrac9GetNextSuperframe(handle) != 2)
+	{
+		printf("the loop didn't wrap to superframe 2\n");
+		failures++;
+	}
+
+	failures += Atrac9SetLoop(handle, -1, -1) != 0;
+	failures += Atrac9GetNextSuperframe(handle) != -1;
+
+	Atrac9ReleaseHandle(handle);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include "libatrac9/libatrac9.h"
+#include "error_codes.h"
+#include "test_stream.h"
+#include <stdio.h>
+
+// 44.1 and 48 kHz streams have the same frame size, so only the rate tells
+// their voices apart. The bus takes the rate of its first voice and rejects
+// the other, until the mixer is initialized again.
+
+#define FRAME_SAMPLES 64
+
+// The test stream's config with the sampling rate index of 44.1 kHz
+static unsigned char Config44100[4] = { 0xFE, 0x84, 0x0D, 0x60 };
+
+static int Mix(void* mixer, void* voice)
+{
+	int bytesUsed;
+	return Atrac9MixVoice(mixer, voice, TestStream, 1.0, &bytesUsed);
+}
+
+int main(void)
+{
+	int failures = 0;
+	void* mixer = Atrac9GetMixer();
+	void* voice48000 = Atrac9GetHandle();
+	void* voice44100 = Atrac9GetHandle();
+
+	if (!mixer || !voice48000 || !voice44100 || Atrac9InitDecoder(voice48000, TestStreamConfig) != 0 ||
+		Atrac9InitDecoder(voice44100, Config44100) != 0)
+	{
+		return 1;
+	}
+
+	Atrac9InitMixer(mixer, 2, FRAME_SAMPLES);
+	failures += Mix(mixer, voice48000) != ERR_SUCCESS;
+	failures += Mix(mixer, voice44100) != ERR_MIXER_VOICE_MISMATCH;
+	failures += Mix(mixer, voice48000) != ERR_SUCCESS;
+
+	Atrac9InitMixer(mixer, 2, FRAME_SAMPLES);
+	failures += Mix(mixer, voice44100) != ERR_SUCCESS;
+	failures += Mix(mixer, voice48000) != ERR_MIXER_VOICE_MISMATCH;
+
+	// A voice resampled to the bus's rate still runs at its own
+	Atrac9InitMixer(mixer, 2, FRAME_SAMPLES);
+	failures += Atrac9SetOutputRate(voice44100, 48000) != 0;
+	failures += Mix(mixer, voice44100) != ERR_RESAMPLER_UNSUPPORTED;
+	failures += Mix(mixer, voice48000) != ERR_SUCCESS;
+
+	if (failures) printf("%d voices were mixed or rejected wrongly\n", failures);
+
+	Atrac9ReleaseHandle(voice44100);
+	Atrac9ReleaseHandle(voice48000);
+	Atrac9ReleaseMixer(mixer);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include "libatrac9/libatrac9.h"
+#include "structures.h"
+#include "test_stream.h"
+#include <math.h>
+#include <stdio.h>
+
+// Trims the test stream to samples 100 to 1100 while resampling it, up and
+// down. Each kept sample is checked against the resampler's filter applied
+// directly to the stream's PCM, with the taps summed in order, so the first
+// one has to sit at stream sample 100 once the filter's latency of half its
+// taps and one is taken off.
+
+#define SUPERFRAME_COUNT 24
+#define SUPERFRAME_BYTES 108
+#define FRAME_SAMPLES 64
+#define CHANNEL_COUNT 2
+#define STREAM_SAMPLES (SUPERFRAME_COUNT * FRAME_SAMPLES)
+#define TRIM_START 100
+#define TRIM_COUNT 1000
+#define OUTPUT_CAPACITY (TRIM_COUNT * 2 + FRAME_SAMPLES)
+
+typedef struct Conversion_s {
+	int outputRate;
+	int taps;
+	int samples;
+} Conversion;
+
+static const Conversion Conversions[] =
+{
+	{ 44100, 48, 919 },
+	{ 12000, 128, 250 },
+	{ 96000, 32, 2000 },
+};
+
+static double StreamPcm[STREAM_SAMPLES * CHANNEL_COUNT];
+static double OutputPcm[OUTPUT_CAPACITY * CHANNEL_COUNT];
+
+static int DecodeStream(const Conversion* conversion, double* pcm, int capacity, Atrac9Handle** handle)
+{
+	double frame[(FRAME_SAMPLES * 2 + 1) * CHANNEL_COUNT];
+	int samples = 0;
+	*handle = Atrac9GetHandle();
+
+	if (!*handle || Atrac9InitDecoder(*handle, TestStreamConfig) != 0) return -1;
+	if (conversion && (Atrac9SetOutputRate(*handle, conversion->outputRate) != 0 ||
+		Atrac9SetTrim(*handle, TRIM_START, TRIM_COUNT) != 0))
+	{
+		return -1;
+	}
+
+	for (int i = 0; i < SUPERFRAME_COUNT; i++)
+	{
+		const unsigned char* superframe = &TestStream[i * SUPERFRAME_BYTES];
+		int bytesUsed;
+		if (Atrac9Decode(*handle, superframe, frame, kAtrac9FormatF64, &bytesUsed) != 0) return -1;
+
+		const int count = Atrac9GetOutputSamples(*handle);
+		if (samples + count > capacity) return -1;
+
+		for (int j = 0; j < count * CHANNEL_COUNT; j++)
+		{
+			pcm[samples * CHANNEL_COUNT + j] = frame[j];
+		}
+		samples += count;
+	}
+
+	return samples;
+}
+
+// Output sample n of the untrimmed stream, filtered the way the resampler
+// does it from the history of taps zeros before the stream
+static double FilterSample(const Resampler* resampler, long long n, int ch)
+{
+	const int taps = resampler->taps;
+	const long long start = n * resampler->inputRate / resampler->outputRate;
+	const long long phase = n * resampler->inputRate % resampler->outputRate;
+	const double position = phase * ((double)RESAMPLER_PHASES / resampler->outputRate);
+	const int index = (int)position;
+	const double fraction = position - index;
+	double sum = 0;
+
+	for (int t = 0; t < taps; t++)
+	{
+		const double lower = resampler->filter[index * taps + t];
+		const double upper = resampler->filter[(index + 1) * taps + t];
+		const long long sample = start + t - taps;
+		if (sample < 0 || sample >= STREAM_SAMPLES) continue;
+
+		sum += (lower + fraction * (upper - lower)) * StreamPcm[sample * CHANNEL_COUNT + ch];
+	}
+
+	return sum;
+}
+
+static int CheckConversion(const Conversion* conversion)
+{
+	Atrac9Handle* handle;
+	const int samples = DecodeStream(conversion, OutputPcm, OUTPUT_CAPACITY, &handle);
+	const Resampler* resampler = handle ? handle->resampler : NULL;
+	int failures = 0;
+
+	if (samples != conversion->samples || !resampler || resampler->taps != conversion->taps)
+	{
+		printf("%d Hz: %d samples with %d taps, expected %d with %d\n", conversion->outputRate, samples,
+			resampler ? resampler->taps : 0, conversion->samples, conversion->taps);
+		Atrac9ReleaseHandle(handle);
+		return 1;
+	}
+
+	// The first output sample whose filter centre, at n * inputRate /
+	// outputRate less the latency, reaches the trim start
+	const long long inputRate = resampler->inputRate;
+	const long long outputRate = resampler->outputRate;
+	const long long latency = resampler->taps / 2 + 1;
+	long long first = 0;
+	while (first * inputRate < (TRIM_START + latency) * outputRate)
+	{
+		first++;
+	}
+
+	for (int i = 0; i < samples && failures == 0; i++)
+	{
+		for (int ch = 0; ch < CHANNEL_COUNT; ch++)
+		{
+			const double expected = FilterSample(resampler, first + i, ch);
+			const double actual = OutputPcm[i * CHANNEL_COUNT + ch];
+
+			if (fabs(actual - expected) > 1e-9 * (1 + fabs(expected)))
+			{
+				printf("%d Hz: sample %d of channel %d is %.17g, expected %.17g\n", conversion->outputRate, i, ch,
+					actual, expected);
+				failures++;
+			}
+		}
+	}
+
+	Atrac9ReleaseHandle(handle);
+	return failures;
+}
+
+int main(void)
+{
+	Atrac9Handle* handle;
+	const int samples = DecodeStream(NULL, StreamPcm, STREAM_SAMPLES, &handle);
+	Atrac9ReleaseHandle(handle);
+	if (samples != STREAM_SAMPLES) return 1;
+
+	int failures = 0;
+
+	for (size_t i = 0; i < sizeof(Conversions) / sizeof(Conversions[0]); i++)
+	{
+		failures += CheckConversion(&Conversions[i]);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include "libatrac9/libatrac9.h"
+#include "test_stream.h"
+#include <stdio.h>
+#include <string.h>
+
+// Parses an .at9 file built in memory whose fact chunk has an input overlap
+// delay different from its encoder delay. Only the encoder delay is
+// dropped, and the loop points are returned past it.
+
+#define SAMPLE_COUNT 1200
+#define OVERLAP_DELAY 128
+#define ENCODER_DELAY 70
+#define LOOP_START 100
+#define LOOP_END 900
+#define DATA_SUPERFRAMES 4
+
+static const unsigned char Atrac9SubFormat[16] =
+{
+	0xD2, 0x42, 0xE1, 0x47, 0xBA, 0x36, 0x8D, 0x4D, 0x88, 0xFC, 0x61, 0x65, 0x4F, 0x8C, 0x83, 0x6C
+};
+
+static unsigned char File[1024];
+
+static void PutU16(unsigned char* data, int value)
+{
+	data[0] = (unsigned char)value;
+	data[1] = (unsigned char)(value >> 8);
+}
+
+static void PutU32(unsigned char* data, unsigned int value)
+{
+	PutU16(data, (int)(value & 0xFFFF));
+	PutU16(&data[2], (int)(value >> 16));
+}
+
+static unsigned char* AddChunk(int* size, const char* id, int chunkSize)
+{
+	unsigned char* chunk = &File[*size];
+	memcpy(chunk, id, 4);
+	PutU32(&chunk[4], chunkSize);
+	*size += 8 + chunkSize;
+	return &chunk[8];
+}
+
+// The fact chunk holds factFields of its three 32-bit fields
+static int BuildFile(int factFields)
+{
+	int size = 12;
+	memset(File, 0, sizeof(File));
+
+	unsigned char* format = AddChunk(&size, "fmt ", 52);
+	PutU16(format, 0xFFFE);
+	PutU16(&format[2], 2);
+	PutU32(&format[4], 48000);
+	PutU16(&format[12], 108);
+	PutU16(&format[16], 34);
+	memcpy(&format[24], Atrac9SubFormat, sizeof(Atrac9SubFormat));
+	memcpy(&format[44], TestStreamConfig, sizeof(TestStreamConfig));
+
+	const unsigned int factValues[3] = { SAMPLE_COUNT, OVERLAP_DELAY, ENCODER_DELAY };
+	unsigned char* fact = AddChunk(&size, "fact", factFields * 4);
+
+	for (int i = 0; i < factFields; i++)
+	{
+		PutU32(&fact[i * 4], factValues[i]);
+	}
+
+	// The sampler chunk counts from the first decoded sample and includes
+	// the loop's last sample
+	unsigned char* sampler = AddChunk(&size, "smpl", 60);
+	PutU32(&sampler[28], 1);
+	PutU32(&sampler[44], LOOP_START + ENCODER_DELAY);
+	PutU32(&sampler[48], LOOP_END + ENCODER_DELAY - 1);
+
+	unsigned char* data = AddChunk(&size, "data", DATA_SUPERFRAMES * 108);
+	memcpy(data, TestStream, DATA_SUPERFRAMES * 108);
+
+	memcpy(File, "RIFF", 4);
+	PutU32(&File[4], size - 8);
+	memcpy(&File[8], "WAVE", 4);
+	return size;
+}
+
+static int Check(int factFields, int encoderDelay, int loopStart, int loopEnd)
+{
+	Atrac9FileInfo info;
+	const int status = Atrac9ParseFile(File, BuildFile(factFields), &info);
+
+	if (status != 0 || info.sampleCount != SAMPLE_COUNT || info.encoderDelay != encoderDelay ||
+		info.loopStart != loopStart || info.loopEnd != loopEnd || info.superframeCount != DATA_SUPERFRAMES)
+	{
+		printf("%d fact fields: status %d, %d samples, delay %d, loop %d to %d, %d superframes\n", factFields,
+			status, info.sampleCount, info.encoderDelay, info.loopStart, info.loopEnd, info.superframeCount);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int failures = Check(3, ENCODER_DELAY, LOOP_START, LOOP_END);
+
+	// Without the encoder delay field nothing is dropped, and the loop
+	// points stay where the sampler chunk puts them
+	failures += Check(2, 0, LOOP_START + ENCODER_DELAY, LOOP_END + ENCODER_DELAY);
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+#include "libatrac9/libatrac9.h"
+#include "test_stream.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Scans the test stream in ranges on separate threads, none of which start
+// before the others, so the shared tables are first built while they race.
+// Every range has to give what a single-threaded scan of it gives, and the
+// stats of the ranges have to add up to those of the whole stream.
+
+#define THREAD_COUNT 8
+#define RANGE_SUPERFRAMES 3
+#define SUPERFRAME_BYTES 108
+#define CHANNEL_COUNT 2
+#define FRAME_SAMPLES 64
+
+typedef struct Range_s {
+	int first;
+	int status;
+	Atrac9ValidationReport report;
+	int analyzeStatus;
+	Atrac9ValidationReport analyzeReport;
+	Atrac9StreamStats stats;
+	int loudnessStatus;
+	Atrac9LoudnessReport loudnessReport;
+	// The test stream has a frame per superframe
+	double envelope[RANGE_SUPERFRAMES];
+	int overviewStatus;
+	Atrac9OverviewReport overviewReport;
+	// A bucket per frame
+	Atrac9OverviewBucket buckets[RANGE_SUPERFRAMES * CHANNEL_COUNT];
+} Range;
+
+static Range Ranges[THREAD_COUNT];
+
+static void ScanRange(Range* range)
+{
+	range->status = Atrac9ValidateRange(TestStreamConfig, TestStream, sizeof(TestStream), range->first,
+		RANGE_SUPERFRAMES, &range->report);
+	range->analyzeStatus = Atrac9Analyze(TestStreamConfig, TestStream, sizeof(TestStream), range->first,
+		RANGE_SUPERFRAMES, &range->stats, &range->analyzeReport);
+	range->loudnessStatus = Atrac9ScanLoudness(TestStreamConfig, &TestStream[range->first * SUPERFRAME_BYTES],
+		RANGE_SUPERFRAMES * SUPERFRAME_BYTES, -70.0, 1, range->envelope, RANGE_SUPERFRAMES, NULL, 0,
+		&range->loudnessReport);
+	range->overviewStatus = Atrac9GetOverview(TestStreamConfig, &TestStream[range->first * SUPERFRAME_BYTES],
+		RANGE_SUPERFRAMES * SUPERFRAME_BYTES, FRAME_SAMPLES, range->buckets, RANGE_SUPERFRAMES,
+		&range->overviewReport);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI RunRange(LPVOID range)
+{
+	ScanRange(range);
+	return 0;
+}
+
+static int ScanRanges(void)
+{
+	HANDLE threads[THREAD_COUNT];
+
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		threads[i] = CreateThread(NULL, 0, RunRange, &Ranges[i], 0, NULL);
+		if (!threads[i]) return 0;
+	}
+
+	WaitForMultipleObjects(THREAD_COUNT, threads, TRUE, INFINITE);
+
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		CloseHandle(threads[i]);
+	}
+	return 1;
+}
+#else
+static void* RunRange(void* range)
+{
+	ScanRange(range);
+	return NULL;
+}
+
+static int ScanRanges(void)
+{
+	pthread_t threads[THREAD_COUNT];
+
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		if (pthread_create(&threads[i], NULL, RunRange, &Ranges[i]) != 0) return 0;
+	}
+
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	return 1;
+}
+#endif
+
+static int CheckSerialScans(void)
+{
+	int failures = 0;
+
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		Range expected;
+		expected.first = Ranges[i].first;
+		ScanRange(&expected);
+
+		if (Ranges[i].status != 0 || expected.status != 0 ||
+			memcmp(&Ranges[i].report, &expected.report, sizeof(Atrac9ValidationReport)) != 0 ||
+			Ranges[i].report.superframesChecked != RANGE_SUPERFRAMES)
+		{
+			printf("validating superframes %d to %d: status %d, expected %d\n", Ranges[i].first,
+				Ranges[i].first + RANGE_SUPERFRAMES - 1, Ranges[i].status, expected.status);
+			failures++;
+		}
+
+		if (Ranges[i].loudnessStatus != 0 || expected.loudnessStatus != 0 ||
+			Ranges[i].loudnessReport.frames != RANGE_SUPERFRAMES ||
+			memcmp(&Ranges[i].loudnessReport, &expected.loudnessReport, sizeof(Atrac9LoudnessReport)) != 0 ||
+			memcmp(Ranges[i].envelope, expected.envelope, sizeof(expected.envelope)) != 0)
+		{
+			printf("measuring superframes %d to %d: status %d, expected %d\n", Ranges[i].first,
+				Ranges[i].first + RANGE_SUPERFRAMES - 1, Ranges[i].loudnessStatus, expected.loudnessStatus);
+			failures++;
+		}
+
+		if (Ranges[i].overviewStatus != 0 || expected.overviewStatus != 0 ||
+			Ranges[i].overviewReport.buckets != RANGE_SUPERFRAMES ||
+			memcmp(&Ranges[i].overviewReport, &expected.overviewReport, sizeof(Atrac9OverviewReport)) != 0 ||
+			memcmp(Ranges[i].buckets, expected.buckets, sizeof(expected.buckets)) != 0)
+		{
+			printf("drawing superframes %d to %d: status %d, expected %d\n", Ranges[i].first,
+				Ranges[i].first + RANGE_SUPERFRAMES - 1, Ranges[i].overviewStatus, expected.overviewStatus);
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+static void AddStats(Atrac9StreamStats* sum, const Atrac9StreamStats* stats)
+{
+	int* sumCounts = (int*)sum;
+	const int* counts = (const int*)stats;
+
+	for (size_t i = 0; i < offsetof(Atrac9StreamStats, spectraBits) / sizeof(int); i++)
+	{
+		sumCounts[i] += counts[i];
+	}
+
+	sum->spectraBits += stats->spectraBits;
+	sum->sideInfoBits += stats->sideInfoBits;
+	sum->paddingBits += stats->paddingBits;
+}
+
+static int CheckAnalysis(void)
+{
+	Atrac9StreamStats sum, whole;
+	Atrac9ValidationReport report;
+	int failures = 0;
+	memset(&sum, 0, sizeof(sum));
+
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		if (Ranges[i].analyzeStatus != 0 ||
+			memcmp(&Ranges[i].analyzeReport, &Ranges[i].report, sizeof(Atrac9ValidationReport)) != 0)
+		{
+			printf("analyzing superframes %d to %d: status %d\n", Ranges[i].first,
+				Ranges[i].first + RANGE_SUPERFRAMES - 1, Ranges[i].analyzeStatus);
+			failures++;
+		}
+
+		AddStats(&sum, &Ranges[i].stats);
+	}
+
+	const int status = Atrac9Analyze(TestStreamConfig, TestStream, sizeof(TestStream), 0,
+		THREAD_COUNT * RANGE_SUPERFRAMES, &whole, &report);
+
+	if (status != 0 || whole.frames != THREAD_COUNT * RANGE_SUPERFRAMES || memcmp(&sum, &whole, sizeof(sum)) != 0)
+	{
+		printf("analyzing the whole stream: status %d, %d frames, stats %s the ranges' sum\n", status,
+			whole.frames, memcmp(&sum, &whole, sizeof(sum)) != 0 ? "differ from" : "match");
+		failures++;
+	}
+
+	return failures;
+}
+
+int main(void)
+{
+	for (int i = 0; i < THREAD_COUNT; i++)
+	{
+		Ranges[i].first = i * RANGE_SUPERFRAMES;
+	}
+
+	if (!ScanRanges())
+	{
+		printf("couldn't start the threads\n");
+		return 1;
+	}
+
+	const int failures = CheckSerialScans() + CheckAnalysis();
+	return failures == 0 ? 0 : 1;
+}
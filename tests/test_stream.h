@@ -0,0 +1,171 @@
+#pragma once
+
+// 24 superframes of a 48 kHz stereo stream, each a single 64-sample frame of
+// 108 bytes, cut from frames that decode on their own
+static unsigned char TestStreamConfig[4] = { 0xFE, 0x94, 0x0D, 0x60 };
+
+static const unsigned char TestStream[2592] =
+{
+	0x00, 0x00, 0x8C, 0x40, 0x01, 0x00, 0x01, 0x10, 0x00, 0x44, 0x03, 0x80, 0x00, 0x40, 0x18, 0x88,
+	0x00, 0x8C, 0x00, 0x51, 0x00, 0x00, 0x00, 0x01, 0x10, 0x00, 0x04, 0x04, 0x00, 0x04, 0x89, 0x40,
+	0x08, 0x41, 0x00, 0x80, 0x90, 0x00, 0x01, 0x08, 0x00, 0x82, 0x00, 0x80, 0x80, 0x20, 0x00, 0x00,
+	0x21, 0x10, 0x60, 0x24, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x84, 0x00, 0x50, 0x01,
+	0x10, 0x09, 0x41, 0x10, 0x40, 0x02, 0x00, 0x88, 0x18, 0x00, 0x00, 0x08, 0x11, 0x00, 0x24, 0x00,
+	0x84, 0x20, 0x01, 0x00, 0x10, 0x40, 0x80, 0x02, 0x80, 0x02, 0x08, 0x0A, 0x00, 0x00, 0x40, 0x00,
+	0x00, 0x80, 0x00, 0xA0, 0x01, 0x01, 0x20, 0x11, 0x00, 0x80, 0x00, 0x01, 0x00, 0x00, 0x40, 0x86,
+	0xA2, 0x50, 0xC8, 0x09, 0x20, 0x09, 0xC0, 0x48, 0x22, 0x00, 0x80, 0x02, 0x06, 0x01, 0x11, 0xA0,
+	0x01, 0x48, 0x80, 0x7E, 0x40, 0x42, 0x97, 0x00, 0x82, 0x54, 0x0A, 0x04, 0x08, 0x01, 0x89, 0xC8,
+	0x09, 0x84, 0x01, 0x11, 0x13, 0x85, 0x90, 0x91, 0x20, 0x42, 0x5D, 0x20, 0x10, 0x45, 0x2C, 0x05,
+	0xA1, 0x00, 0x26, 0x20, 0x8A, 0x1C, 0x04, 0x04, 0x70, 0x08, 0x42, 0x00, 0x02, 0x40, 0x00, 0x00,
+	0x40, 0x48, 0x04, 0x0A, 0x00, 0x92, 0x02, 0x01, 0x08, 0x40, 0x20, 0x64, 0x40, 0x21, 0x90, 0x20,
+	0x00, 0x41, 0xA4, 0x10, 0x01, 0x50, 0x01, 0x00, 0xC0, 0x24, 0x08, 0x20, 0x40, 0x14, 0x11, 0x00,
+	0x88, 0x01, 0x66, 0x18, 0x00, 0x10, 0x62, 0xC9, 0x15, 0x1E, 0x0A, 0x00, 0x11, 0x2C, 0x18, 0x04,
+	0x34, 0x40, 0xCC, 0x01, 0xD6, 0xB8, 0x1B, 0x90, 0x20, 0x02, 0x04, 0x4A, 0x00, 0x02, 0x88, 0x80,
+	0x40, 0xF3, 0x04, 0x4D, 0x50, 0x41, 0xC0, 0x02, 0x41, 0xE1, 0x05, 0x34, 0x0C, 0x49, 0xA0, 0x21,
+	0x88, 0x0C, 0x73, 0x48, 0x51, 0x82, 0xBC, 0x02, 0x00, 0x01, 0x84, 0x70, 0x28, 0xF0, 0x1D, 0x80,
+	0x35, 0x11, 0x00, 0x96, 0x09, 0xC0, 0x10, 0x00, 0x41, 0xA0, 0x12, 0x82, 0x04, 0x81, 0x01, 0xE1,
+	0x80, 0x20, 0x5C, 0xC0, 0x00, 0x40, 0x42, 0x11, 0x00, 0x45, 0x98, 0x88, 0xCA, 0x28, 0x98, 0x02,
+	0x81, 0x8A, 0x19, 0x64, 0xC1, 0x80, 0x00, 0x26, 0x40, 0x22, 0x20, 0x14, 0x2C, 0x61, 0x42, 0x75,
+	0xA1, 0xA3, 0x04, 0x02, 0x00, 0x10, 0x40, 0x40, 0x88, 0x40, 0x03, 0x00, 0x06, 0x01, 0x08, 0x00,
+	0x00, 0x82, 0x29, 0x08, 0x21, 0x00, 0x01, 0x00, 0x01, 0x28, 0x00, 0x00, 0x21, 0x00, 0x00, 0x88,
+	0x11, 0x10, 0x80, 0x00, 0x41, 0x00, 0x12, 0x01, 0x80, 0x41, 0x01, 0xB8, 0x00, 0x00, 0x00, 0xE8,
+	0x07, 0x24, 0x00, 0x02, 0xA0, 0x00, 0x11, 0x00, 0x08, 0x08, 0x20, 0x02, 0x38, 0x10, 0x10, 0x10,
+	0x00, 0x00, 0x00, 0x50, 0x80, 0x10, 0x80, 0x04, 0x10, 0x34, 0x10, 0x00, 0x03, 0x02, 0x00, 0x00,
+	0x00, 0x80, 0x14, 0x41, 0x00, 0x00, 0x00, 0x02, 0x00, 0x49, 0x01, 0x00, 0x0A, 0x80, 0x50, 0x00,
+	0x4A, 0x0C, 0x04, 0x00, 0x00, 0x59, 0xC0, 0x00, 0x20, 0x00, 0x42, 0x00, 0x20, 0x08, 0x00, 0x44,
+	0x04, 0x00, 0x04, 0x28, 0x88, 0x01, 0x00, 0x00, 0x00, 0x42, 0x01, 0x08, 0x00, 0x00, 0x00, 0x02,
+	0x00, 0x00, 0x04, 0x02, 0x00, 0x40, 0x80, 0x00, 0x00, 0x42, 0x02, 0x20, 0x08, 0x00, 0x01, 0x09,
+	0x11, 0xB0, 0x00, 0xA0, 0x60, 0x00, 0x00, 0x40, 0x50, 0x10, 0x00, 0x88, 0x00, 0x00, 0x40, 0x0B,
+	0x00, 0x42, 0x00, 0x40, 0x10, 0x0A, 0x40, 0x5A, 0x00, 0x00, 0x00, 0x00, 0x90, 0x83, 0x20, 0x00,
+	0x03, 0x01, 0x00, 0x32, 0x00, 0x00, 0x00, 0x00, 0xA8, 0xC0, 0xE0, 0x82, 0x40, 0x00, 0x80, 0x60,
+	0x00, 0x00, 0x08, 0x80, 0x01, 0x00, 0x80, 0x00, 0x00, 0x00, 0x41, 0x04, 0x00, 0x00, 0x00, 0x00,
+	0x84, 0x91, 0x01, 0x80, 0x00, 0x20, 0x40, 0x00, 0x00, 0x80, 0x10, 0x01, 0x00, 0x00, 0x08, 0x10,
+	0x00, 0x81, 0x00, 0x82, 0x80, 0x0A, 0x10, 0x00, 0x00, 0x40, 0x83, 0x00, 0x01, 0x00, 0x04, 0x19,
+	0x08, 0x20, 0x00, 0x0C, 0x00, 0x0C, 0x20, 0x10, 0x12, 0xC0, 0x00, 0x00, 0xA0, 0x00, 0x40, 0x50,
+	0x80, 0x02, 0x00, 0x41, 0x00, 0x08, 0x8A, 0x02, 0x02, 0x12, 0x80, 0x00, 0x04, 0x29, 0x20, 0x30,
+	0x6C, 0x40, 0x80, 0x20, 0x00, 0x04, 0x44, 0x10, 0x81, 0x00, 0x08, 0x00, 0x00, 0x00, 0x70, 0x00,
+	0x08, 0x06, 0x00, 0x01, 0x20, 0x20, 0xA0, 0x01, 0x44, 0x10, 0x80, 0x01, 0x40, 0x20, 0x91, 0x01,
+	0x00, 0x40, 0x00, 0x02, 0x12, 0x81, 0x00, 0x00, 0x40, 0x00, 0x48, 0x40, 0x00, 0x28, 0x04, 0x00,
+	0x00, 0x00, 0x10, 0x91, 0x10, 0x00, 0x20, 0x00, 0x00, 0x08, 0xC8, 0x08, 0x00, 0x30, 0x08, 0x03,
+	0x00, 0x00, 0x40, 0x08, 0x80, 0x24, 0x11, 0x00, 0x91, 0x00, 0x20, 0x20, 0x80, 0x00, 0x00, 0x06,
+	0x30, 0x46, 0x80, 0x09, 0x00, 0x20, 0x80, 0x00, 0x12, 0x08, 0x00, 0x30, 0x00, 0x20, 0x14, 0x89,
+	0x04, 0x1E, 0x0D, 0x40, 0x01, 0x81, 0x01, 0x70, 0x00, 0x04, 0x00, 0x00, 0x80, 0x7C, 0x00, 0x04,
+	0x60, 0x00, 0x20, 0x00, 0x40, 0x40, 0xC2, 0x00, 0x00, 0x11, 0xA0, 0x05, 0x41, 0x10, 0x20, 0x20,
+	0x00, 0x00, 0x00, 0x08, 0x38, 0x80, 0x18, 0x80, 0x12, 0x40, 0x80, 0x00, 0x20, 0x0A, 0x10, 0x12,
+	0x20, 0xE0, 0x90, 0x01, 0x01, 0x00, 0x81, 0x00, 0x08, 0x00, 0x00, 0x08, 0xA6, 0x05, 0xA0, 0x00,
+	0x00, 0x22, 0x00, 0x00, 0x10, 0x54, 0x00, 0x00, 0x12, 0x60, 0x00, 0x86, 0x04, 0x04, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x04, 0x08, 0x80, 0x28, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x2A, 0x00, 0x00, 0x04, 0x00, 0x48, 0x18, 0x00, 0x42, 0x03, 0x05, 0x80, 0x09, 0x80, 0x11, 0xA2,
+	0xC1, 0xA4, 0x80, 0x43, 0x83, 0x20, 0x08, 0x00, 0x00, 0x20, 0x00, 0x80, 0x04, 0x00, 0x20, 0x04,
+	0x00, 0x02, 0x02, 0x08, 0x01, 0x14, 0x80, 0x08, 0x00, 0x02, 0x00, 0x20, 0x04, 0x03, 0x05, 0x02,
+	0x80, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x10, 0x00, 0xA0, 0x00, 0x00, 0x04, 0x45, 0x40, 0x04,
+	0x82, 0x00, 0x00, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00, 0x09, 0x08, 0x03, 0x00, 0x02, 0x01, 0x00,
+	0x00, 0x00, 0x02, 0xC2, 0x00, 0x90, 0x00, 0x00, 0x91, 0x00, 0x01, 0x00, 0x10, 0x00, 0x02, 0x02,
+	0x02, 0x04, 0x04, 0x30, 0x20, 0x00, 0x01, 0x00, 0x02, 0xC0, 0x48, 0x00, 0x00, 0x42, 0x10, 0x90,
+	0x45, 0x40, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x81, 0x00, 0x00, 0x00, 0x01, 0x00, 0x40, 0x00,
+	0x10, 0x0C, 0x09, 0x10, 0x24, 0x00, 0x80, 0x00, 0x20, 0x18, 0x10, 0x00, 0x00, 0x40, 0x30, 0x58,
+	0x20, 0x40, 0x80, 0x10, 0x02, 0x09, 0x08, 0x00, 0x12, 0x00, 0x00, 0x43, 0xA2, 0x08, 0x00, 0x12,
+	0xC0, 0x18, 0x00, 0x01, 0x10, 0x08, 0x00, 0x40, 0x40, 0x04, 0x08, 0x44, 0x90, 0x84, 0x00, 0x00,
+	0x28, 0xD0, 0x00, 0x00, 0x30, 0x02, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04,
+	0x80, 0x00, 0x00, 0x08, 0x00, 0x16, 0x08, 0x00, 0x30, 0x20, 0x41, 0x00, 0x02, 0x02, 0x48, 0x00,
+	0x10, 0x08, 0x01, 0x12, 0x04, 0x20, 0x41, 0x40, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x80, 0x20,
+	0x90, 0x09, 0x1A, 0x01, 0x00, 0x00, 0x11, 0x20, 0x00, 0x08, 0xE1, 0x01, 0x10, 0x00, 0x01, 0x80,
+	0x04, 0x00, 0x58, 0x28, 0x00, 0x08, 0x00, 0x00, 0x00, 0x04, 0x86, 0x08, 0x02, 0xC2, 0x08, 0x10,
+	0x34, 0x00, 0x10, 0x40, 0x00, 0x00, 0xE1, 0x00, 0x25, 0x08, 0x09, 0x50, 0x20, 0x00, 0x00, 0x08,
+	0x00, 0x00, 0x00, 0xAE, 0x04, 0x00, 0x01, 0x04, 0x40, 0x80, 0x00, 0x08, 0x00, 0x00, 0x80, 0x24,
+	0x02, 0x44, 0x20, 0x44, 0x80, 0x40, 0x00, 0x20, 0x00, 0x00, 0x00, 0x01, 0x84, 0x54, 0x00, 0x02,
+	0x60, 0x80, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x01, 0x00, 0x90, 0x00,
+	0x00, 0x02, 0x04, 0x81, 0x00, 0x40, 0x00, 0x44, 0x40, 0xA1, 0x84, 0x00, 0x02, 0x00, 0x05, 0x20,
+	0x00, 0xA0, 0x02, 0x80, 0x01, 0x80, 0x40, 0x00, 0x00, 0x00, 0x10, 0x44, 0x00, 0x01, 0x22, 0x00,
+	0x02, 0x00, 0x00, 0x40, 0x02, 0x06, 0x00, 0x02, 0x00, 0xA0, 0x04, 0x00, 0x00, 0x11, 0x00, 0x08,
+	0x05, 0x01, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x18, 0x81, 0x08, 0x00, 0x04, 0x1C, 0x82, 0x00, 0x00,
+	0x88, 0x21, 0x00, 0x00, 0x10, 0x10, 0x00, 0x41, 0x20, 0x00, 0x01, 0x55, 0x40, 0x04, 0x00, 0x42,
+	0x00, 0x42, 0x01, 0x00, 0x04, 0x00, 0x08, 0x00, 0x08, 0x01, 0x00, 0x80, 0x20, 0x80, 0x0C, 0x02,
+	0x2A, 0x30, 0x00, 0x08, 0x54, 0x0A, 0x25, 0x04, 0x00, 0x04, 0x00, 0x80, 0x00, 0x40, 0x00, 0x08,
+	0x28, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x95, 0x00, 0xA9, 0x42, 0x08, 0x00, 0x00, 0x02,
+	0x04, 0x00, 0x80, 0x10, 0x89, 0x08, 0x04, 0x50, 0x06, 0x08, 0x40, 0xC4, 0x00, 0x00, 0x02, 0x08,
+	0x32, 0x01, 0x00, 0x00, 0x08, 0x0C, 0x00, 0x00, 0x40, 0x00, 0x09, 0x40, 0x50, 0x40, 0x00, 0x01,
+	0x00, 0x02, 0x02, 0x10, 0x80, 0x00, 0x0C, 0x00, 0x10, 0xC8, 0x09, 0x00, 0x10, 0x10, 0x29, 0x00,
+	0x80, 0x00, 0x82, 0x02, 0x80, 0x00, 0x00, 0x00, 0x00, 0x20, 0x48, 0x00, 0x08, 0x0A, 0x01, 0x22,
+	0x00, 0x11, 0x00, 0x05, 0x99, 0x80, 0x80, 0x04, 0x80, 0x00, 0x08, 0x08, 0x00, 0x00, 0x80, 0x00,
+	0x80, 0x00, 0x06, 0x40, 0x00, 0xA4, 0x00, 0x00, 0x02, 0x10, 0x40, 0x00, 0x20, 0x02, 0x40, 0xC0,
+	0x04, 0x21, 0x22, 0x01, 0x0C, 0x00, 0x88, 0x00, 0x00, 0x10, 0x02, 0x04, 0x0D, 0x80, 0x00, 0x08,
+	0x18, 0x10, 0x44, 0x61, 0x21, 0x04, 0x09, 0x0A, 0x20, 0x42, 0x00, 0x08, 0x08, 0x00, 0x22, 0x8E,
+	0x80, 0x00, 0x21, 0x01, 0x80, 0x35, 0x00, 0x0C, 0x00, 0x00, 0x14, 0x10, 0xA1, 0x8A, 0x00, 0x51,
+	0x01, 0x24, 0x00, 0x00, 0x14, 0x00, 0x10, 0x00, 0x01, 0x20, 0x00, 0x10, 0x00, 0x02, 0x80, 0x80,
+	0x01, 0x00, 0xEA, 0x40, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x05, 0x11, 0x00, 0x88, 0x20,
+	0x04, 0x02, 0x40, 0x82, 0x00, 0x00, 0x08, 0x60, 0x12, 0x21, 0x00, 0x10, 0x40, 0x00, 0x00, 0x00,
+	0x20, 0x00, 0xA2, 0x00, 0x60, 0x00, 0x60, 0x00, 0x08, 0x00, 0x04, 0x09, 0x00, 0x00, 0x00, 0x00,
+	0x40, 0x0A, 0x40, 0x00, 0x00, 0x04, 0x21, 0x00, 0x85, 0x00, 0x80, 0x08, 0x00, 0x04, 0x80, 0x00,
+	0x10, 0x40, 0xB0, 0x00, 0x42, 0x80, 0x50, 0x05, 0x00, 0x18, 0x04, 0x40, 0x00, 0x80, 0x00, 0x10,
+	0x0A, 0x02, 0x08, 0x00, 0x82, 0x08, 0x00, 0x00, 0x01, 0x84, 0x40, 0x61, 0x00, 0x00, 0x02, 0x00,
+	0x40, 0x00, 0x00, 0x00, 0x02, 0x02, 0x40, 0x00, 0x80, 0x02, 0x04, 0x41, 0x81, 0x00, 0x00, 0x21,
+	0x04, 0x22, 0x80, 0x01, 0x11, 0x00, 0x40, 0x06, 0x00, 0x18, 0x00, 0x00, 0x08, 0x90, 0x10, 0x04,
+	0x00, 0x84, 0x01, 0x24, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x08, 0x10, 0x40, 0x30, 0x03, 0x00,
+	0x00, 0x40, 0x00, 0x01, 0x10, 0x30, 0x00, 0x00, 0x84, 0x23, 0x00, 0x20, 0x4C, 0x82, 0x32, 0x10,
+	0x03, 0x82, 0x00, 0x20, 0x80, 0x04, 0x00, 0x10, 0x80, 0x8C, 0x06, 0x40, 0x00, 0x00, 0x81, 0x00,
+	0x80, 0xA8, 0x10, 0x40, 0x40, 0x0A, 0x20, 0x04, 0x44, 0x18, 0x1A, 0x00, 0x00, 0x60, 0x05, 0x00,
+	0x06, 0x00, 0x04, 0x00, 0x03, 0x00, 0x00, 0x10, 0x02, 0x00, 0x91, 0x80, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x41, 0x00, 0x40, 0x22, 0x00, 0x04, 0x40, 0x02, 0x18, 0x38, 0x28, 0x00, 0x04, 0x60,
+	0x22, 0x09, 0x34, 0x20, 0x00, 0x08, 0x00, 0x05, 0x03, 0x14, 0x85, 0x00, 0x01, 0x04, 0x00, 0x04,
+	0x04, 0x00, 0x40, 0x00, 0x00, 0x90, 0x00, 0xA4, 0x08, 0x90, 0x10, 0x20, 0x00, 0x00, 0x08, 0x04,
+	0x01, 0x80, 0x00, 0x08, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x31, 0x20, 0x00, 0x02, 0x05, 0x11,
+	0x40, 0x00, 0x00, 0x00, 0x00, 0x20, 0x85, 0x81, 0x08, 0x84, 0x26, 0x00, 0x12, 0x43, 0x02, 0x40,
+	0x02, 0x04, 0x30, 0x40, 0x60, 0x01, 0x02, 0x40, 0x00, 0x10, 0x02, 0x00, 0x00, 0x00, 0x49, 0x80,
+	0x82, 0x00, 0x08, 0x10, 0xA0, 0x40, 0x02, 0x02, 0x40, 0x20, 0x10, 0x60, 0x10, 0x40, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x18, 0x48, 0x80, 0x80, 0x80, 0x00, 0x22, 0x02, 0x00, 0x88, 0x82, 0x00, 0x00,
+	0x08, 0x80, 0x00, 0xAA, 0x42, 0x00, 0x22, 0x08, 0x10, 0x22, 0x40, 0x31, 0x48, 0x04, 0x00, 0x01,
+	0x10, 0x10, 0x40, 0x00, 0x00, 0x08, 0x10, 0x30, 0x00, 0x88, 0x0C, 0x00, 0x00, 0x00, 0x00, 0xA0,
+	0x00, 0x03, 0x00, 0x00, 0x00, 0x10, 0x02, 0x26, 0x20, 0x00, 0x00, 0x00, 0x00, 0x86, 0x44, 0x20,
+	0x00, 0x05, 0x08, 0x20, 0x40, 0x42, 0x10, 0x08, 0x01, 0x90, 0x40, 0x22, 0x42, 0x00, 0x00, 0xC0,
+	0x12, 0x90, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x08, 0x09, 0x00, 0x10, 0x88, 0x08, 0x04,
+	0x64, 0x40, 0xA0, 0x00, 0x35, 0x03, 0x00, 0x40, 0x00, 0x48, 0x08, 0x00, 0x20, 0x00, 0x20, 0x01,
+	0x10, 0x00, 0x00, 0x04, 0x04, 0x00, 0x10, 0x05, 0x29, 0x06, 0x00, 0x84, 0x00, 0x00, 0x28, 0x18,
+	0x04, 0x0B, 0x40, 0x00, 0x19, 0x81, 0x08, 0x00, 0x04, 0x00, 0x01, 0x01, 0x00, 0x80, 0x24, 0x06,
+	0x00, 0x40, 0x00, 0x00, 0x00, 0x80, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00, 0x40, 0x40, 0x80, 0x18,
+	0x02, 0x48, 0x80, 0x00, 0x22, 0x02, 0x20, 0x10, 0x20, 0x00, 0x00, 0x02, 0x01, 0x02, 0x00, 0x05,
+	0x92, 0x84, 0x40, 0x00, 0x41, 0x4C, 0x03, 0x08, 0x00, 0x00, 0x80, 0x81, 0x41, 0x00, 0x40, 0x02,
+	0x01, 0xC0, 0x04, 0xC0, 0x00, 0x00, 0xC0, 0x40, 0x00, 0x04, 0x06, 0x40, 0x04, 0x00, 0x10, 0x20,
+	0x04, 0x19, 0x03, 0x01, 0x20, 0x09, 0x25, 0x41, 0x00, 0x01, 0x20, 0x11, 0x28, 0x00, 0x00, 0x01,
+	0x04, 0x40, 0x00, 0x80, 0x00, 0xE0, 0x01, 0x01, 0x10, 0x28, 0x0A, 0x88, 0x60, 0x00, 0x00, 0x44,
+	0x80, 0xB0, 0x00, 0x82, 0x00, 0x00, 0x11, 0x01, 0x10, 0x28, 0xB0, 0x90, 0x80, 0x10, 0x02, 0x01,
+	0x04, 0x00, 0x19, 0x02, 0x05, 0x01, 0x30, 0x10, 0x00, 0x08, 0x20, 0x00, 0x00, 0x8C, 0x10, 0x00,
+	0x02, 0x50, 0x0E, 0x04, 0x04, 0x20, 0x02, 0x01, 0x00, 0x04, 0x40, 0x05, 0x00, 0x08, 0x82, 0x00,
+	0x10, 0x00, 0x90, 0x00, 0x24, 0x00, 0x86, 0x04, 0x98, 0x20, 0x34, 0x00, 0x40, 0x10, 0x00, 0x00,
+	0x0C, 0x14, 0x00, 0x00, 0x80, 0x00, 0x02, 0x01, 0x90, 0x84, 0x94, 0x08, 0x08, 0x00, 0x10, 0x20,
+	0x01, 0x80, 0x8C, 0x10, 0x01, 0x90, 0x01, 0x02, 0x84, 0x80, 0x00, 0x05, 0x84, 0x18, 0x80, 0x12,
+	0xC0, 0x00, 0x00, 0x00, 0x00, 0x10, 0x16, 0x01, 0x10, 0x80, 0x20, 0x00, 0x00, 0xC2, 0x00, 0x00,
+	0x00, 0x80, 0x00, 0x04, 0x04, 0x00, 0x00, 0x00, 0x48, 0x01, 0xC0, 0x00, 0x40, 0x00, 0x81, 0x01,
+	0x00, 0x00, 0x08, 0x00, 0x08, 0x0C, 0x10, 0x40, 0x20, 0x80, 0x00, 0x06, 0x00, 0x01, 0x24, 0x40,
+	0x00, 0x50, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x01, 0x80, 0x00, 0x00, 0x06, 0x40,
+	0x00, 0x00, 0x04, 0x04, 0x82, 0x04, 0x01, 0x00, 0x11, 0x00, 0x00, 0x24, 0x26, 0x8C, 0xE0, 0x02,
+	0x02, 0x00, 0x00, 0x01, 0x90, 0x00, 0x00, 0x08, 0x85, 0x00, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00,
+	0x88, 0x20, 0x04, 0x02, 0x20, 0x00, 0x20, 0x10, 0x00, 0x00, 0x00, 0x00, 0x04, 0x20, 0x00, 0x00,
+	0x00, 0x09, 0x28, 0x00, 0x50, 0x00, 0x10, 0x80, 0x48, 0x20, 0x00, 0x38, 0x59, 0x81, 0x01, 0x3C,
+	0x10, 0x20, 0x02, 0xE0, 0x10, 0x04, 0x10, 0x15, 0x0C, 0x01, 0x02, 0x19, 0x20, 0x68, 0x01, 0xC2,
+	0x86, 0x10, 0x18, 0x97, 0x42, 0xFB, 0x64, 0x14, 0xC8, 0xA3, 0x88, 0x82, 0x08, 0x00, 0x4A, 0x00,
+	0x38, 0x00, 0x02, 0x88, 0x22, 0x50, 0x01, 0x00, 0x65, 0x10, 0x00, 0x38, 0xC0, 0x09, 0x00, 0xC2,
+	0x01, 0x02, 0x20, 0x80, 0x01, 0x21, 0xCB, 0x10, 0x53, 0x00, 0x04, 0x80, 0x18, 0x11, 0x8A, 0x0A,
+	0x0A, 0x48, 0x10, 0x10, 0x00, 0x00, 0xA2, 0x48, 0x20, 0x01, 0x16, 0xA0, 0x10, 0x01, 0x00, 0x44,
+	0x01, 0x94, 0x05, 0x04, 0xCA, 0x44, 0x10, 0x42, 0x47, 0x00, 0x01, 0x51, 0x04, 0x00, 0x42, 0xA4,
+	0x88, 0x04, 0xA1, 0x7C, 0x00, 0x00, 0x02, 0x00, 0x00, 0x02, 0x80, 0x48, 0x60, 0x00, 0x00, 0x20,
+	0x40, 0x48, 0x01, 0x00, 0x00, 0x00, 0x08, 0x04, 0x00, 0x00, 0x10, 0x02, 0x01, 0x00, 0x00, 0x02,
+	0x18, 0xA2, 0x80, 0x50, 0x40, 0x82, 0x20, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x48, 0x00,
+	0x40, 0x08, 0x05, 0x00, 0x84, 0x06, 0x88, 0x00, 0x00, 0x04, 0x01, 0x00, 0x00, 0x81, 0x21, 0x10,
+	0x00, 0xC0, 0x00, 0x00, 0x06, 0x0C, 0x01, 0x11, 0x00, 0x00, 0x00, 0x11, 0x00, 0x08, 0x00, 0x00,
+	0x00, 0x80, 0x8C, 0x00, 0x06, 0x00, 0x00, 0x02, 0x1A, 0x30, 0x80, 0x20, 0x00, 0xC8, 0x00, 0x30,
+	0x01, 0x4C, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0A, 0x04, 0x90, 0x01, 0x00,
+	0x02, 0x00, 0x02, 0x01, 0x04, 0x02, 0x09, 0x50, 0x40, 0x00, 0x88, 0x10, 0x80, 0x80, 0x00, 0x42,
+	0x07, 0x30, 0x02, 0x10, 0x00, 0x54, 0xB0, 0x60, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x40, 0x04,
+	0x02, 0x00, 0x00, 0x00, 0x93, 0x01, 0x44, 0x02, 0x08, 0x00, 0x01, 0x42, 0x00, 0x00, 0xE2, 0x20,
+	0x00, 0x20, 0x2C, 0x04, 0x24, 0x00, 0x28, 0x00, 0x52, 0x19, 0x00, 0x12, 0x01, 0x24, 0x83, 0x88,
+	0x00, 0x00, 0x05, 0x40, 0x20, 0xA0, 0x80, 0x08, 0x12, 0x88, 0x00, 0x00, 0x20, 0x00, 0xC0, 0x80,
+	0x00, 0x70, 0x20, 0x10, 0x84, 0x00, 0x20, 0x00, 0x20, 0x00, 0x00, 0x02, 0x1D, 0x10, 0x18, 0x08,
+	0x20, 0x00, 0x10, 0x26, 0x00, 0x00, 0x00, 0x81, 0x01, 0x00, 0x24, 0x40, 0x01, 0x41, 0x20, 0x00,
+	0x00, 0xC8, 0x00, 0x20, 0x20, 0x00, 0x09, 0x20, 0x00, 0x08, 0x02, 0x00, 0x08, 0x00, 0x00, 0x00,
+	0x00, 0x08, 0x00, 0x00, 0x18, 0x00, 0x80, 0x00, 0x00, 0x90, 0x00, 0x30, 0x00, 0x80, 0x92, 0x08,
+	0x02, 0x02, 0x00, 0x00, 0x04, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x08, 0x00, 0x06, 0x80, 0x01,
+	0x02, 0x00, 0x20, 0x60, 0x08, 0x60, 0x40, 0x00, 0xA0, 0x8C, 0x08, 0x28, 0x80, 0x00, 0x04, 0x8A,
+	0x00, 0x20, 0x80, 0x00, 0x80, 0x08, 0x02, 0x00, 0x00, 0x00, 0x10, 0x80, 0x04, 0x88, 0x11, 0x16,
+	0x80, 0x00, 0x81, 0x92, 0x40, 0x03, 0x00, 0x20, 0x00, 0x31, 0x04, 0x40, 0x00, 0x00, 0x00, 0x00,
+};
@@ -0,0 +1,53 @@
+#include "libatrac9/libatrac9.h"
+#include "error_codes.h"
+#include "test_stream.h"
+#include <stdio.h>
+#include <string.h>
+
+// Clears the first frame flag of a superframe, so its first frame carries
+// over from the one before. Atrac9Decode still plays it, and validation
+// reports it as dependent rather than as a parse error.
+
+#define SUPERFRAME_BYTES 108
+#define SUPERFRAME_COUNT 4
+#define DEPENDENT_SUPERFRAME 2
+#define FRAME_SAMPLES 64
+
+static unsigned char Stream[SUPERFRAME_COUNT * SUPERFRAME_BYTES];
+
+int main(void)
+{
+	Atrac9ValidationReport report;
+	int failures = 0;
+
+	memcpy(Stream, TestStream, sizeof(Stream));
+	Stream[DEPENDENT_SUPERFRAME * SUPERFRAME_BYTES] |= 0x80;
+
+	const int status = Atrac9Validate(TestStreamConfig, Stream, sizeof(Stream), &report);
+
+	if (status != ERR_VALIDATE_SUPERFRAME_DEPENDENT || report.error != status ||
+		report.failedSuperframe != DEPENDENT_SUPERFRAME || report.failedFrame != 0)
+	{
+		printf("validation gave %x at superframe %d, frame %d\n", status, report.failedSuperframe, report.failedFrame);
+		failures++;
+	}
+
+	void* handle = Atrac9GetHandle();
+	if (!handle || Atrac9InitDecoder(handle, TestStreamConfig) != 0) return 1;
+
+	for (int i = 0; i < SUPERFRAME_COUNT; i++)
+	{
+		short pcm[FRAME_SAMPLES * 2];
+		int bytesUsed;
+		const int decodeStatus = Atrac9Decode(handle, &Stream[i * SUPERFRAME_BYTES], pcm, kAtrac9FormatS16, &bytesUsed);
+
+		if (decodeStatus != 0)
+		{
+			printf("decoding superframe %d gave %x\n", i, decodeStatus);
+			failures++;
+		}
+	}
+
+	Atrac9ReleaseHandle(handle);
+	return failures == 0 ? 0 : 1;
+}